@@ -0,0 +1,137 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "config.hpp"
+#include "rng.hpp"
+
+class Tourist;
+
+// Proces przyjść turystów w godzinach Tp..Tk.
+// - burst: wszyscy w chwili 0 (dawne zachowanie),
+// - poisson: niejednorodny proces Poissona, intensywność stała w każdym z
+//   równych przedziałów dnia (--day-ms) i proporcjonalna do wagi z
+//   --arrival-profile; średnio --tourists przyjść na dzień.
+// - trace: zapis z bramek czytany strumieniowo (rekord po rekordzie) i
+//   odtwarzany --replay-speed razy szybciej; czas liczony od pierwszego rekordu.
+//   Format: CSV "arrival_ts_ms,age,vip" (puste linie i '#' pomijane, nagłówek
+//   też) albo binarny: "PARKARR1", potem rekordy TraceRecord (little endian).
+// Wiek i VIP (burst/poisson) losowane tym samym mt19937(seed) co dawniej w main.
+class ArrivalProcess {
+public:
+    struct Arrival {
+        int64_t at_ms;   // czas symulacji od otwarcia (Tp)
+        int age;
+        bool vip;
+    };
+
+    struct TraceRecord {
+        int64_t ts_ms;
+        int32_t age;
+        int32_t vip;
+    };
+    static constexpr char TRACE_MAGIC[8] = {'P', 'A', 'R', 'K', 'A', 'R', 'R', '1'};
+
+    /**
+     * @brief Arrival process described by --arrivals, --day-ms and --arrival-profile.
+     */
+    explicit ArrivalProcess(const Config& cfg);
+    ~ArrivalProcess();
+
+    ArrivalProcess(const ArrivalProcess&) = delete;
+    ArrivalProcess& operator=(const ArrivalProcess&) = delete;
+
+    /**
+     * @brief False when the trace file could not be opened (reason already printed).
+     */
+    bool ok() const { return ok_; }
+    /**
+     * @brief Trace lines/records skipped as malformed.
+     */
+    int skipped() const { return skipped_; }
+
+    /**
+     * @brief Next arrival in time order; false once the day (or --tourists in burst mode) is over.
+     */
+    bool next(Arrival& a);
+
+private:
+    const Config& cfg_;
+    std::vector<double> rate_per_ms_;   // intensywność w każdym przedziale dnia
+    double slot_ms_ = 0.0;
+    double t_ms_ = 0.0;
+    int emitted_ = 0;
+
+    bool ok_ = true;
+    FILE* in_ = nullptr;
+    bool binary_ = false;
+    bool header_seen_ = false;
+    bool have_ts0_ = false;
+    int64_t ts0_ = 0;
+    int64_t last_ms_ = 0;
+    int skipped_ = 0;
+
+    RngStream gaps_;
+    std::mt19937 demo_;
+    std::uniform_int_distribution<int> age_dist_{3, 70};
+    std::bernoulli_distribution vip_dist_;
+
+    /**
+     * @brief Advance t_ms_ by one exponential gap, crossing slot boundaries (memoryless); false past Tk.
+     */
+    bool advance();
+    /**
+     * @brief Read the next valid trace record; false at end of file.
+     */
+    bool read_trace(TraceRecord& r);
+};
+
+// Turyści obecni w parku. Obiekt żyje od przyjścia do wyjścia - pamięć
+// rośnie z liczbą jednoczesnych gości, nie z liczbą gości w ciągu dnia.
+class Visitors {
+public:
+    /**
+     * @brief Start @p t and keep it until it reports finished().
+     */
+    void start(std::unique_ptr<Tourist> t);
+
+    /**
+     * @brief Free tourists that already finished (joins their threads).
+     */
+    void reap();
+
+    /**
+     * @brief Block (not as a clock actor) until every started tourist finished and was freed.
+     */
+    void wait_all();
+
+    /**
+     * @brief Tourists started so far.
+     */
+    int started() const;
+    /**
+     * @brief Most tourists alive at the same time.
+     */
+    int peak_live() const;
+
+private:
+    mutable std::mutex mu_;
+    std::condition_variable cv_;
+    std::unordered_map<Tourist*, std::unique_ptr<Tourist>> live_;
+    std::vector<Tourist*> done_;
+    int started_ = 0;
+    int peak_ = 0;
+
+    /**
+     * @brief Called by the tourist as its very last action.
+     */
+    void finished(Tourist* t);
+};
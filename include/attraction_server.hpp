@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "config.hpp"
+#include "direction.hpp"
+#include "event_bus.hpp"
+#include "ipc_msg.hpp"
+#include "resources.hpp"
+
+// Serwery atrakcji (--attractions=server w --mode=process).
+// Most, wieża i prom to osobne procesy-arbitrzy: zdejmują żądania z kolejki
+// komunikatów (mtype 1), stosują te same reguły co Bridge/Tower/Ferry
+// (kierunek i FIFO na moście, SlotQueue z fairness VIP w wieży i na promie)
+// i odpowiadają RES_DONE do mtype = pid turysty w osobnej kolejce odpowiedzi
+// (pełna kolejka żądań nie zablokuje odpowiedzi). Po jednym blokującym
+// msgrcv serwer dobiera resztę zaległych żądań z IPC_NOWAIT - jedno
+// obudzenie obsługuje całą paczkę. Kanał to kolejka SysV albo pierścień
+// w pamięci dzielonej (--ipc, ipc_ring.hpp) - serwer widzi tylko MsgChannel.
+
+enum class Attraction : int { BRIDGE = 0, TOWER = 1, FERRY = 2 };
+
+/**
+ * @brief Per-server counters in the shared segment.
+ *
+ * Server fields have a single writer (the server); the client fields are
+ * updated by tourists through std::atomic_ref.
+ */
+struct ServerStats {
+    // serwer
+    uint64_t reqs;
+    uint64_t wakeups;            // blokujące recv_req, które coś zwróciły
+    uint64_t max_batch;
+    int64_t req_lat_ns_sum;      // od send_req klienta do zdjęcia przez serwer
+    int64_t req_lat_ns_max;
+    int64_t busy_ns;             // obsługa paczek (bez czekania i rejsów promu)
+    // klienci
+    uint64_t replies;
+    int64_t res_lat_ns_sum;      // od wysłania odpowiedzi do jej odebrania
+    int64_t res_lat_ns_max;
+    int64_t rtt_ns_sum;          // REQ_CROSS -> RES_DONE (z czekaniem na miejsce)
+};
+
+/**
+ * @brief CLOCK_MONOTONIC in ns (comparable between processes).
+ */
+int64_t mono_ns();
+
+class AttractionServer {
+public:
+    /**
+     * @brief Arbiter for @p kind reading @p req and replying on @p res.
+     */
+    AttractionServer(Attraction kind, const Config& cfg, EventBus& bus,
+                     MsgChannel& req, MsgChannel& res, ServerStats& st);
+
+    /**
+     * @brief Serve until REQ_STOP; ends the process with _exit.
+     */
+    [[noreturn]] void run();
+
+private:
+    Attraction kind_;
+    const Config& cfg_;
+    EventBus& bus_;
+    MsgChannel& req_;
+    MsgChannel& res_;
+    ServerStats& st_;
+    bool stop_ = false;
+    std::unordered_map<int, int> pid_of_;   // tourist id -> pid (adres odpowiedzi)
+
+    // Most
+    int br_count_ = 0;
+    Direction br_dir_ = Direction::NONE;
+    Direction br_last_ = Direction::NONE;   // kierunek, który ostatnio opróżnił most
+    struct BridgeWaiter {
+        int id;
+        int k;
+    };
+    std::deque<BridgeWaiter> br_q_[2];     // czekający per kierunek
+
+    // Wieża i prom (slots_[0]; prom: brzegi 0/1)
+    SlotQueue slots_[2];
+    int bank_ = 0;
+    uint64_t trips_ = 0;
+
+    /**
+     * @brief Block for one request, then drain the channel without waiting; false on error.
+     */
+    bool serve_batch();
+    /**
+     * @brief Handle every queued request without blocking; returns how many.
+     */
+    uint64_t drain();
+    /**
+     * @brief Apply one request to the attraction state.
+     */
+    void handle(const BridgeReqMsg& m);
+    /**
+     * @brief RES_DONE to the tourist.
+     */
+    void reply(int id);
+
+    /**
+     * @brief Bridge::enter() rules for a party of @p k: FIFO per direction, one direction at a time.
+     */
+    void bridge_enter(int id, Direction d, int k);
+    /**
+     * @brief Bridge::leave() of @p k places; the last one out hands the bridge to the other side first.
+     */
+    void bridge_leave(int id, int k);
+    /**
+     * @brief Grant free places to the queue of the current (or next) direction.
+     */
+    void bridge_grant();
+
+    /**
+     * @brief Grant tower slots to queued tickets.
+     */
+    void tower_grant();
+
+    /**
+     * @brief Ferry shuttle: load at the current bank, cross, unload, until stopped and empty.
+     */
+    [[noreturn]] void ferry_loop();
+};
@@ -3,12 +3,31 @@
 #include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 struct Config {
-    int tourists_total = 30;
+    int tourists_total = 30;   // burst: dokładnie tylu; poisson: średnio tylu na dzień
+    std::string arrivals = "burst";       // burst (wszyscy na starcie) | poisson
+    int day_ms = 60000;                   // poisson: długość dnia Tp..Tk w czasie symulacji
+    std::string arrival_profile = "1";    // poisson: wagi intensywności w równych przedziałach dnia
+    std::string arrivals_file;            // trace: CSV "ts_ms,age,vip" albo binarny PARKARR1
+    double replay_speed = 1.0;            // trace: przyspieszenie odtwarzania (60 = minuta w sekundę)
     int N = 100;          // max per day
     int M = 5;            // group size
     int P = 2;            // guides
+    int P_min = 0;        // --P-max > 0: elastyczna pula przewodników [P_min, P_max] (0 = min(P, P_max))
+    int P_max = 0;        // 0 = stała pula P
+    int guide_up_depth = 0;       // elastyczna: dołóż przewodnika przy tylu czekających (0 = 2*M)
+    int guide_up_wait_ms = 2000;  // ... albo gdy najstarszy czeka dłużej
+    int guide_idle_ms = 2000;     // ... odeślij dodatkowego po takim czasie bezczynności
+    int cashiers = 1;     // kasjerzy (osobne kolejki wejściowe, wspólny limit N)
+    int cashier_ms = 0;   // czas obsługi jednej osoby przy kasie (0 = natychmiast)
+    int entry_cap = 0;    // >0: najwyżej tylu czekających do kas, kolejni rezygnują (balk)
+    int patience_ms = 0;  // >0: czekający w kolejce do kas odchodzą po tylu ms (renege)
+    int group_timeout_ms = 0;   // >0: po tylu ms czekania najstarszego przewodnik rusza z niepełną grupą
+    int group_min = 1;          // minimalna wielkość takiej grupy
+    std::string group_policy = "fifo";   // fifo | compose (dobór składu w oknie group_window)
+    int group_window = 0;                // compose: ilu czekających rozważać naraz (0 = 2*M)
     int X1 = 3;           // bridge cap
     int X2 = 8;           // tower cap
     int X3 = 7;           // ferry cap
@@ -25,14 +44,31 @@ struct Config {
     double signal2_prob = 0.05;
     double vip_prob     = 0.1;
 
+    std::string route_policy = "random";   // random | congestion (trasa o krótszym przewidywanym czasie)
+
     int status_port = -1;
     unsigned int seed = 1234;
 
+    std::string clock_mode = "real";   // real | virtual
+    std::string exec = "threads";      // threads (wątek na turystę) | coro (korutyny na puli)
+    std::string mode = "inproc";       // inproc | process (turysta = proces potomny, pojemności na semaforach SysV)
+    std::string attractions = "sem";   // process: sem | server (most, wieża, prom jako procesy z kolejką komunikatów)
+    std::string ipc = "msg";           // server: msg (kolejki SysV) | ring (pierścień w shm + futex)
+    std::string workload;              // guided | solo (każdy sam, bez przewodników); puste = solo dla process, inaczej guided
+    int workers = 0;                   // coro: liczba wątków puli, 0 = liczba rdzeni
+
+    std::string log_mode = "sync";     // sync | async
+    std::string log_format = "text";   // text | binary (logs/park.bin, czytaj parklog-dump) | none
+    int stats = 0;                     // 1 = licznik zdarzeń w podsumowaniu ([EVENTS])
+    std::string trace_path;            // niepuste = zapis Chrome trace
+    int log_flush_ms = 50;             // async: okres opróżniania kolejki
+    int log_queue = 65536;             // async: pojemność pierścienia (rekordy)
+
     /**
      * @brief Parse command-line arguments into a Config.
      *
-     * Recognises flags like --tourists, --N, --M, --P, --X1..X3, duration ranges,
-     * signal probabilities, vip probability, status port and seed.
+     * Recognises flags like --tourists, --arrivals/--day-ms/--arrival-profile/--arrivals-file/--replay-speed, --N, --M, --P, --P-min/--P-max (elastic guides), --cashiers, --cashier-ms, --entry-cap, --patience-ms, --group-timeout-ms, --group-min, --group-policy/--group-window, --X1..X3, duration ranges,
+     * signal probabilities, vip probability, route policy, status port, seed, clock mode, execution mode (--exec, --mode, --attractions, --ipc, --workload), logger options and event subscribers.
      *
      * @param argc argument count from main
      * @param argv argument vector from main
@@ -40,6 +76,29 @@ struct Config {
      */
     static Config from_args(int argc, char** argv);
 
+    /**
+     * @brief Guides and groups run (--workload=guided); solo = every admitted tourist walks alone.
+     */
+    bool guided() const { return workload == "guided"; }
+    /**
+     * @brief Elastic guide pool requested (--P-max > 0).
+     */
+    bool elastic_guides() const { return P_max > 0; }
+    /**
+     * @brief Guides always on duty: P, or P_min in elastic mode.
+     */
+    int guides_core() const { return !elastic_guides() ? P : (P_min > 0 ? P_min : (P < P_max ? P : P_max)); }
+
+    /**
+     * @brief Weights from --arrival-profile; empty when malformed, negative or all zero.
+     */
+    std::vector<double> arrival_weights() const;
+
+    /**
+     * @brief Look-ahead window of the compose group policy.
+     */
+    int group_window_size() const { return group_window > 0 ? group_window : 2 * M; }
+
     /**
      * @brief Validate constraints or throw std::runtime_error with description.
      */
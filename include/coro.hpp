@@ -0,0 +1,282 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sim_clock.hpp"
+
+// Tryb korutynowy (--exec=coro).
+// Turyści, przewodnicy i kasjer to zadania CoTask wykonywane przez pulę
+// wątków z kradzieżą pracy (Scheduler).
+// Ten sam kod działa też w trybie wątkowym: poza wątkiem Schedulera
+// awaitable po prostu blokują bieżący wątek (jak dawniej cv.wait/sleep).
+
+class Scheduler;
+
+/**
+ * @brief Lazily started coroutine returning nothing.
+ *
+ * co_await on a CoTask runs it to completion and resumes the caller
+ * (symmetric transfer, no extra scheduling).
+ */
+class CoTask {
+public:
+    struct promise_type {
+        std::coroutine_handle<> cont;      // kto czeka na zakończenie
+        Scheduler* owner = nullptr;        // zadanie główne (spawn) - sprząta się samo
+        bool daemon = false;               // spawn_daemon: nie liczy się do wait_all()
+        std::exception_ptr exc;
+
+        CoTask get_return_object() {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept;
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { exc = std::current_exception(); }
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    CoTask() = default;
+    explicit CoTask(handle_type h) : h_(h) {}
+    CoTask(CoTask&& o) noexcept : h_(std::exchange(o.h_, {})) {}
+    CoTask& operator=(CoTask&& o) noexcept {
+        if (this != &o) {
+            if (h_) h_.destroy();
+            h_ = std::exchange(o.h_, {});
+        }
+        return *this;
+    }
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+    ~CoTask() { if (h_) h_.destroy(); }
+
+    bool await_ready() const noexcept { return !h_ || h_.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        h_.promise().cont = caller;
+        return h_;
+    }
+    void await_resume() {
+        if (h_.promise().exc) std::rethrow_exception(h_.promise().exc);
+    }
+
+    /**
+     * @brief Run the task on the calling thread (thread mode: nothing suspends).
+     */
+    void run_inline();
+
+    /**
+     * @brief Give up ownership of the coroutine frame.
+     */
+    handle_type release() { return std::exchange(h_, {}); }
+
+private:
+    handle_type h_;
+};
+
+/**
+ * @brief Work-stealing pool of worker threads resuming ready coroutines.
+ *
+ * Each worker owns a deque: it pushes and pops its own work at the back
+ * (LIFO, hot cache), idle workers steal from the front (FIFO). Work
+ * coming from other threads (timers, main) goes to a shared inject queue.
+ * Every queued handle holds one SimClock unit (hold()/release()), so in
+ * virtual mode time only moves once all queues are empty.
+ */
+class Scheduler {
+public:
+    struct Stats {
+        int workers = 0;
+        uint64_t tasks = 0;        // wznowienia korutyn
+        uint64_t steals = 0;
+        int64_t idle_ms = 0;       // suma po workerach
+        double wall_s = 0.0;       // od startu puli do stop()
+    };
+
+    /**
+     * @brief Start @p workers threads (0 = hardware concurrency).
+     */
+    Scheduler(int workers, SimClock& clock);
+    /**
+     * @brief Stop and join the workers.
+     */
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /**
+     * @brief Scheduler owning the calling worker thread, or nullptr on other threads.
+     */
+    static Scheduler* current();
+
+    /**
+     * @brief Start a detached root task; its frame is freed when it finishes.
+     */
+    void spawn(CoTask t);
+    /**
+     * @brief Like spawn(), but wait_all() does not wait for it (service loops like the ferry).
+     */
+    void spawn_daemon(CoTask t);
+    /**
+     * @brief Queue a suspended coroutine for resumption.
+     */
+    void schedule(std::coroutine_handle<> h);
+    /**
+     * @brief Like schedule(), but the clock unit was already taken (timer callbacks).
+     */
+    void schedule_held(std::coroutine_handle<> h);
+
+    /**
+     * @brief Block until every spawned task has finished.
+     */
+    void wait_all();
+    /**
+     * @brief Stop worker threads (idempotent).
+     */
+    void stop();
+
+    /**
+     * @brief Called from a finishing root task.
+     */
+    void task_done();
+
+    /**
+     * @brief Throughput counters (complete after stop()).
+     */
+    Stats stats() const;
+
+private:
+    struct Worker {
+        std::mutex mu;
+        std::deque<std::coroutine_handle<>> q;
+        std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<int64_t> idle_ns{0};
+        std::thread thr;
+    };
+
+    SimClock& clock_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex inject_mu_;
+    std::deque<std::coroutine_handle<>> inject_;   // praca spoza workerów
+
+    std::atomic<int64_t> queued_{0};   // suma elementów we wszystkich kolejkach
+    std::atomic<int> idle_{0};         // workerzy śpiący na cv_
+
+    mutable std::mutex mu_;
+    std::condition_variable cv_;        // budzi uśpionych workerów
+    std::condition_variable done_cv_;   // wait_all()
+    int live_ = 0;                      // niezakończone zadania główne
+    bool stop_ = false;
+
+    std::chrono::steady_clock::time_point t_start_;
+    std::chrono::steady_clock::time_point t_stop_;
+
+    /**
+     * @brief Worker thread body.
+     */
+    void worker_loop(int idx);
+    /**
+     * @brief Own deque (LIFO), then inject queue, then steal (FIFO) from others.
+     */
+    bool find_work(int idx, std::coroutine_handle<>& h);
+};
+
+/**
+ * @brief Condition variable usable from both threads and coroutines.
+ *
+ * Waiter list is protected by the monitor mutex, so notify_all() must be
+ * called with that mutex held. Usage: while (!pred) co_await cv.wait(lk);
+ */
+class CoCondition {
+public:
+    struct Awaiter {
+        CoCondition& c;
+        std::unique_lock<std::mutex>& lk;
+        Scheduler* sched = nullptr;
+        std::mutex* m = nullptr;
+
+        bool await_ready() {
+            sched = Scheduler::current();
+            if (sched) return false;
+            // Zwykły wątek: jedno czekanie na cv, pętla z predykatem jest u wołającego.
+            c.wait_thread(lk);
+            return true;
+        }
+        void await_suspend(std::coroutine_handle<> h) {
+            c.waiters_.emplace_back(sched, h);
+            // Po unlock korutyna może już działać na innym wątku - nie dotykamy ramki.
+            m = lk.release();
+            m->unlock();
+        }
+        void await_resume() {
+            if (m) lk = std::unique_lock<std::mutex>(*m);
+        }
+    };
+
+    /**
+     * @brief Release @p lk and wait for notify_all(); @p lk is held again afterwards.
+     */
+    Awaiter wait(std::unique_lock<std::mutex>& lk) { return Awaiter{*this, lk}; }
+
+    /**
+     * @brief Wake every waiting thread and coroutine; monitor mutex must be held.
+     */
+    void notify_all();
+
+private:
+    std::condition_variable cv_;
+    std::vector<std::pair<Scheduler*, std::coroutine_handle<>>> waiters_;
+    int thread_waiters_ = 0;   // wątki w wait_thread() (tryb wirtualny)
+    uint64_t epoch_ = 0;       // notify_all() z czekającymi wątkami
+
+    /**
+     * @brief One cv wait of a plain thread; in virtual mode it stays blocked until notify_all().
+     */
+    void wait_thread(std::unique_lock<std::mutex>& lk);
+};
+
+/**
+ * @brief Awaitable sleep in simulation time.
+ *
+ * On a Scheduler worker the coroutine is parked on a SimClock timer;
+ * elsewhere it is plain SimClock::sleep_ms().
+ */
+struct co_sleep {
+    int ms;
+    Scheduler* sched = nullptr;
+
+    explicit co_sleep(int ms_) : ms(ms_) {}
+
+    bool await_ready() {
+        if (ms <= 0) return true;
+        sched = Scheduler::current();
+        if (sched) return false;
+        SimClock::global().sleep_ms(ms);
+        return true;
+    }
+    void await_suspend(std::coroutine_handle<> h) {
+        Scheduler* s = sched;
+        SimClock::global().call_after(ms, [s, h] { s->schedule_held(h); });
+    }
+    void await_resume() {}
+};
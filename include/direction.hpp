@@ -0,0 +1,15 @@
+#pragma once
+
+enum class Direction { NONE = 0, FORWARD = 1, BACKWARD = 2 };
+
+/**
+ * @brief Convert Direction enum to short string.
+ */
+static inline const char* dir_str(Direction d) {
+    switch (d) {
+        case Direction::NONE: return "NONE";
+        case Direction::FORWARD: return "FWD";
+        case Direction::BACKWARD: return "BWD";
+    }
+    return "?";
+}
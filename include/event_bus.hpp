@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "event_log.hpp"
+#include "events.hpp"
+
+// Zdarzenie po "spłaszczeniu" do pól liczbowych (układ jak w szablonie Ev).
+struct EventRecord {
+    Ev type = Ev::TEXT;
+    int nargs = 0;
+    int64_t args[EV_MAX_ARGS] = {};
+};
+
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+
+    /**
+     * @brief Receive one event.
+     *
+     * Called synchronously on the emitting thread, often while a monitor
+     * mutex is held, so implementations must be thread-safe and short.
+     *
+     * @param t_ms simulation time of the event
+     * @param r event type and fields
+     */
+    virtual void on_event(int64_t t_ms, const EventRecord& r) = 0;
+};
+
+// Szyna zdarzeń: emit() bez subskrybentów to jedno porównanie, bez alokacji
+// i bez formatowania. Subskrybentów dodajemy przed startem wątków symulacji.
+class EventBus {
+public:
+    /**
+     * @brief Attach a sink; not thread-safe, call before the simulation starts.
+     */
+    void subscribe(EventSink* s);
+
+    /**
+     * @brief True when at least one sink is attached.
+     */
+    bool active() const { return !sinks_.empty(); }
+
+    /**
+     * @brief Publish a typed event (see events.hpp) to all sinks.
+     */
+    template <class E>
+    void emit(const E& e) {
+        // Pola zdarzenia muszą odpowiadać placeholderom szablonu (EV_SCHEMA) - błąd
+        // kompilacji zamiast linii BAD_EVENT w logu.
+        static_assert(std::tuple_size_v<decltype(e.fields())> == ev_schema(E::kind).nargs,
+                      "event fields do not match its EV_SCHEMA template");
+        if (sinks_.empty()) return;
+        EventRecord r;
+        r.type = E::kind;
+        std::apply([&r](auto... f) {
+            ((r.args[r.nargs++] = static_cast<int64_t>(f)), ...);
+        }, e.fields());
+        publish(r);
+    }
+
+private:
+    std::vector<EventSink*> sinks_;
+
+    /**
+     * @brief Timestamp the record and hand it to every sink.
+     */
+    void publish(const EventRecord& r);
+};
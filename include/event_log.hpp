@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Zdarzenia o stałym układzie pól.
+// Każde ma tag i szablon treści; ten sam szablon służy do zapisu tekstowego
+// i do odtwarzania tekstu z logu binarnego (parklog-dump), więc oba formaty
+// dają identyczne linie.
+//
+// Placeholdery w szablonie:
+//   %i - liczba całkowita
+//   %d - Direction (NONE/FWD/BWD)
+//   %c - znak (np. punkt trasy K/A/B/C)
+enum class Ev : uint8_t {
+    TEXT = 0,               // dowolna linia (tag + treść)
+
+    CASHIER_START,
+    CASHIER_STOP,
+    CASHIER_ENTER,
+    CASHIER_EXIT,
+    CASHIER_REJECT,
+
+    BRIDGE_DIR_SET,
+    BRIDGE_ENTER,
+    BRIDGE_LEAVE,
+
+    TOWER_QUEUE_JOIN,
+    TOWER_ENTER,
+    TOWER_LEAVE,
+    TOWER_GROUP_QUEUE_JOIN,
+    TOWER_GROUP_ENTER,
+    TOWER_GROUP_LEAVE,
+    TOWER_DENY_AGE5,
+    TOWER_DENY_GUARD_OF_U5,
+    TOWER_DENY_GUARD_CANNOT,
+    TOWER_GROUP_SKIP,
+    TOWER_EVACUATE_GROUP,
+
+    FERRY_QUEUE_JOIN,
+    FERRY_BOARD,
+    FERRY_UNBOARD,
+    FERRY_GROUP_QUEUE_JOIN,
+    FERRY_GROUP_BOARD,
+    FERRY_GROUP_UNBOARD,
+    FERRY_GROUP_SKIP,
+    FERRY_DEPART,
+    FERRY_ARRIVE,
+
+    TOURIST_ARRIVE,
+    TOURIST_GROUP_JOIN,
+    TOURIST_RETURN_K,
+    TOURIST_LEAVE_NO_ENTRY,
+    TOURIST_BALK,
+    TOURIST_RENEGE,
+
+    GUIDE_START,
+    GUIDE_STOP,
+    GUIDE_GROUP_START,
+    GUIDE_GROUP_END,
+    GUIDE_SEGMENT,
+    GUIDE_SIGNAL1,
+    GUIDE_SIGNAL2,
+    GUIDE_SCALE_UP,
+    GUIDE_SCALE_DOWN,
+
+    GUARD_DENY_NO_GUARD,
+    GUARD_NONE,
+    GUARD_ASSIGN,
+    GUARD_CHILD_ABORT_WAIT,
+
+    VIP_DENY_CHILD,
+    VIP_START,
+    VIP_TOWER_SKIP,
+    VIP_END,
+
+    COUNT
+};
+
+static constexpr int EV_MAX_ARGS = 10;
+
+struct EvSchema {
+    const char* tag;
+    const char* fmt;
+    int nargs;
+};
+
+/**
+ * @brief Event table indexed by Ev; order must follow the enum.
+ *
+ * In the header so the arity is known at compile time (EventBus::emit() checks it).
+ */
+inline constexpr EvSchema EV_SCHEMA[] = {
+    {"",        "",                                                                                            0}, // TEXT
+
+    {"CASHIER", "START",                                                                                       0},
+    {"CASHIER", "STOP",                                                                                        0},
+    {"CASHIER", "ENTER id=%i age=%i vip=%i count=%i/%i pay=%i",                                                6},
+    {"CASHIER", "EXIT id=%i",                                                                                  1},
+    {"CASHIER", "REJECT id=%i reason=LIMIT_N",                                                                 1},
+
+    {"BRIDGE",  "BRIDGE_DIR_SET dir=%d",                                                                       1},
+    {"BRIDGE",  "ENTER id=%i dir=%d occ=%i/%i",                                                                4},
+    {"BRIDGE",  "LEAVE id=%i occ=%i/%i",                                                                       3},
+
+    {"TOWER",   "QUEUE_JOIN id=%i vip=%i wait_vip=%i wait_norm=%i",                                            4},
+    {"TOWER",   "ENTER id=%i vip=%i occ=%i/%i wait_vip=%i wait_norm=%i vip_streak=%i",                         7},
+    {"TOWER",   "LEAVE id=%i occ=%i/%i",                                                                       3},
+    {"TOWER",   "GROUP_QUEUE_JOIN gid=%i k=%i vip_like=%i wait_vip=%i wait_norm=%i",                           5},
+    {"TOWER",   "GROUP_ENTER gid=%i k=%i vip_like=%i occ=%i/%i wait_vip=%i wait_norm=%i vip_streak=%i",        8},
+    {"TOWER",   "GROUP_LEAVE gid=%i k=%i occ=%i/%i",                                                           4},
+    {"TOWER",   "DENY id=%i reason=AGE<=5",                                                                    1},
+    {"TOWER",   "DENY id=%i reason=GUARD_OF_AGE<=5",                                                           1},
+    {"TOWER",   "DENY id=%i reason=GUARD_CANNOT_TOWER",                                                        1},
+    {"TOWER",   "GROUP_SKIP gid=%i reason=NO_ELIGIBLE",                                                        1},
+    {"TOWER",   "EVACUATE_GROUP gid=%i k=%i",                                                                  2},
+
+    {"FERRY",   "QUEUE_JOIN id=%i vip=%i dir=%d wait_vip=%i wait_norm=%i",                                     5},
+    {"FERRY",   "BOARD id=%i vip=%i dir=%d occ=%i/%i wait_vip=%i wait_norm=%i vip_streak=%i",                  8},
+    {"FERRY",   "UNBOARD id=%i occ=%i/%i",                                                                     3},
+    {"FERRY",   "GROUP_QUEUE_JOIN gid=%i k=%i vip_like=%i dir=%d wait_vip=%i wait_norm=%i",                    6},
+    {"FERRY",   "GROUP_BOARD gid=%i k=%i vip_like=%i dir=%d occ=%i/%i wait_vip=%i wait_norm=%i vip_streak=%i", 9},
+    {"FERRY",   "GROUP_UNBOARD gid=%i k=%i occ=%i/%i",                                                         4},
+    {"FERRY",   "GROUP_SKIP gid=%i reason=NO_ELIGIBLE",                                                        1},
+    {"FERRY",   "DEPART trip=%i dir=%d load=%i/%i",                                                            4},
+    {"FERRY",   "ARRIVE trip=%i dir=%d unload=%i",                                                             3},
+
+    {"TOURIST", "ARRIVE id=%i age=%i vip=%i",                                                                  3},
+    {"TOURIST", "GROUP_JOIN id=%i gid=%i guide=%i",                                                            3},
+    {"TOURIST", "RETURN_K id=%i gid=%i",                                                                       2},
+    {"TOURIST", "LEAVE_NO_ENTRY id=%i",                                                                        1},
+    {"TOURIST", "BALK id=%i queued=%i cap=%i",                                                                 3},
+    {"TOURIST", "RENEGE id=%i waited_ms=%i",                                                                   2},
+
+    {"GUIDE",   "START guide=%i",                                                                              1},
+    {"GUIDE",   "STOP guide=%i",                                                                               1},
+    {"GUIDE",   "GROUP_START guide=%i gid=%i route=%i",                                                        3},
+    {"GUIDE",   "GROUP_END guide=%i gid=%i",                                                                   2},
+    {"GUIDE",   "SEGMENT %c->%c gid=%i",                                                                       3},
+    {"GUIDE",   "SIGNAL1 guide=%i gid=%i",                                                                     2},
+    {"GUIDE",   "SIGNAL2 guide=%i gid=%i",                                                                     2},
+    {"GUIDE",   "SCALE_UP guide=%i active=%i depth=%i oldest_wait_ms=%i",                                      4},
+    {"GUIDE",   "SCALE_DOWN guide=%i active=%i",                                                               2},
+
+    {"GUARD",   "DENY_NO_GUARD id=%i age=%i where=%c gid=%i",                                                  4},
+    {"GUARD",   "GUARD_NONE child=%i age=%i gid=%i",                                                           3},
+    {"GUARD",   "GUARD_ASSIGN child=%i age=%i guardian=%i gid=%i",                                             4},
+    {"GUARD",   "CHILD_ABORT_WAIT id=%i where=%c gid=%i",                                                      3},
+
+    {"VIP",     "DENY_CHILD id=%i age=%i reason=NEEDS_GUARDIAN",                                               2},
+    {"VIP",     "START id=%i route=%i",                                                                        2},
+    {"VIP",     "TOWER_SKIP id=%i reason=AGE<=5",                                                              1},
+    {"VIP",     "END id=%i",                                                                                   1},
+
+};
+
+static_assert(sizeof(EV_SCHEMA) / sizeof(EV_SCHEMA[0]) == static_cast<size_t>(Ev::COUNT),
+              "EV_SCHEMA must list every Ev");
+
+/**
+ * @brief Number of %i/%d/%c placeholders in template @p f.
+ */
+constexpr int ev_placeholders(const char* f) {
+    int n = 0;
+    for (; *f; ++f) {
+        if (*f != '%' || f[1] == '\0') continue;
+        ++f;
+        if (*f == 'i' || *f == 'd' || *f == 'c') ++n;
+    }
+    return n;
+}
+
+/**
+ * @brief Every row: nargs equals its placeholders and fits EV_MAX_ARGS.
+ */
+constexpr bool ev_schema_consistent() {
+    for (const EvSchema& s : EV_SCHEMA) {
+        if (s.nargs != ev_placeholders(s.fmt) || s.nargs > EV_MAX_ARGS) return false;
+    }
+    return true;
+}
+
+static_assert(ev_schema_consistent(), "EV_SCHEMA: nargs must match the template and fit EV_MAX_ARGS");
+
+/**
+ * @brief Tag, message template and argument count for event @p e.
+ */
+constexpr const EvSchema& ev_schema(Ev e) {
+    return EV_SCHEMA[static_cast<size_t>(e)];
+}
+
+/**
+ * @brief Render the message body of event @p e (without timestamp and tag).
+ */
+std::string ev_format(Ev e, const int64_t* args);
+
+// ---- format binarny ----
+// Plik: nagłówek EV_MAGIC, potem rekordy:
+//   varint(zigzag(dt_ms)) | u8 typ | pola
+// dt_ms liczone względem poprzedniego rekordu. Pola zdarzeń to kolejne
+// varint(zigzag(arg)); TEXT to varint(len)+tag, varint(len)+treść.
+// Numery typów zależą od kolejności Ev - po zmianie enuma podbijamy wersję w EV_MAGIC.
+
+static constexpr char EV_MAGIC[8] = {'P', 'A', 'R', 'K', 'L', 'O', 'G', '4'};
+
+// Górna granica długości napisu w rekordzie TEXT; dłuższa oznacza uszkodzony plik.
+static constexpr uint64_t EV_MAX_STRING = 1 << 20;
+
+struct EvRecord {
+    int64_t t_ms = 0;          // czas bezwzględny (po zsumowaniu delt)
+    Ev type = Ev::TEXT;
+    int64_t args[EV_MAX_ARGS] = {};
+    std::string tag;           // tylko TEXT
+    std::string msg;           // tylko TEXT
+};
+
+/**
+ * @brief Streaming reader of binary park logs.
+ */
+class EvReader {
+public:
+    /**
+     * @brief Wrap an open file; validates the header on first next().
+     */
+    explicit EvReader(std::FILE* f) : f_(f) {}
+
+    /**
+     * @brief Read the next record.
+     * @return true on success, false on EOF or corrupt input (see error()).
+     */
+    bool next(EvRecord& r);
+
+    /**
+     * @brief Non-empty when reading stopped because of malformed data.
+     */
+    const std::string& error() const { return err_; }
+
+    /**
+     * @brief Render a record as the text logger would ("t=..ms TAG msg").
+     */
+    static std::string to_text(const EvRecord& r);
+
+private:
+    std::FILE* f_;
+    bool header_ok_ = false;
+    int64_t t_ms_ = 0;
+    std::string err_;
+
+    bool get_varint(uint64_t& v);
+    bool get_svarint(int64_t& v);
+    bool get_string(std::string& s);
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "event_bus.hpp"
+
+// Agregator statystyk: liczniki zdarzeń i maksymalne obłożenie atrakcji.
+class EventStats : public EventSink {
+public:
+    /**
+     * @brief Count the event and track peak occupancy.
+     */
+    void on_event(int64_t t_ms, const EventRecord& r) override;
+
+    /**
+     * @brief Number of events of type @p e seen so far.
+     */
+    uint64_t count(Ev e) const { return counts_[static_cast<size_t>(e)].load(); }
+
+    /**
+     * @brief Print a one-line "[EVENTS] ..." summary.
+     */
+    void print_summary(std::ostream& os) const;
+
+private:
+    std::atomic<uint64_t> counts_[static_cast<size_t>(Ev::COUNT)] = {};
+    std::atomic<uint64_t> total_{0};
+
+    struct Peak {
+        std::atomic<int> occ{0};
+        std::atomic<int> cap{0};
+    };
+    Peak bridge_, tower_, ferry_;
+
+    /**
+     * @brief Raise peak occupancy atomically.
+     */
+    static void note_peak(Peak& p, int64_t occ, int64_t cap);
+};
+
+// Tracer: zapis w formacie Chrome trace (chrome://tracing, Perfetto).
+// Pobyt na atrakcji to para B/E, obłożenie to licznik, reszta to zdarzenia chwilowe.
+class EventTracer : public EventSink {
+public:
+    /**
+     * @brief Open @p path for writing; throws std::runtime_error on failure.
+     */
+    explicit EventTracer(const std::string& path);
+    /**
+     * @brief Close the JSON array and the file.
+     */
+    ~EventTracer() override;
+
+    EventTracer(const EventTracer&) = delete;
+    EventTracer& operator=(const EventTracer&) = delete;
+
+    /**
+     * @brief Append the event to the trace file.
+     */
+    void on_event(int64_t t_ms, const EventRecord& r) override;
+
+private:
+    std::FILE* f_ = nullptr;
+    std::mutex mu_;
+    bool first_ = true;
+
+    /**
+     * @brief Write one JSON object (mu_ held).
+     */
+    void put(const std::string& obj);
+};
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <tuple>
+
+#include "direction.hpp"
+#include "event_log.hpp"
+
+// Typowane zdarzenia symulacji (EventBus::emit).
+// Kolejność pól = kolejność placeholderów w szablonie zdarzenia (event_log.cpp).
+// Pola są zwykłymi wartościami: zbudowanie zdarzenia nic nie alokuje,
+// formatowanie robią dopiero subskrybenci.
+
+// ------------------------- CASHIER -------------------------
+
+struct CashierStart {
+    static constexpr Ev kind = Ev::CASHIER_START;
+    auto fields() const { return std::make_tuple(); }
+};
+
+struct CashierStop {
+    static constexpr Ev kind = Ev::CASHIER_STOP;
+    auto fields() const { return std::make_tuple(); }
+};
+
+struct CashierEnter {
+    static constexpr Ev kind = Ev::CASHIER_ENTER;
+    int id;
+    int age;
+    bool vip;
+    int count;
+    int limit;
+    int pay;
+    auto fields() const { return std::make_tuple(id, age, vip, count, limit, pay); }
+};
+
+struct CashierExit {
+    static constexpr Ev kind = Ev::CASHIER_EXIT;
+    int id;
+    auto fields() const { return std::make_tuple(id); }
+};
+
+struct CashierReject {
+    static constexpr Ev kind = Ev::CASHIER_REJECT;
+    int id;
+    auto fields() const { return std::make_tuple(id); }
+};
+
+
+// ------------------------- BRIDGE (A) -------------------------
+
+struct BridgeDirSet {
+    static constexpr Ev kind = Ev::BRIDGE_DIR_SET;
+    Direction dir;
+    auto fields() const { return std::make_tuple(dir); }
+};
+
+struct BridgeEnter {
+    static constexpr Ev kind = Ev::BRIDGE_ENTER;
+    int id;
+    Direction dir;
+    int occ;
+    int cap;
+    auto fields() const { return std::make_tuple(id, dir, occ, cap); }
+};
+
+struct BridgeLeave {
+    static constexpr Ev kind = Ev::BRIDGE_LEAVE;
+    int id;
+    int occ;
+    int cap;
+    auto fields() const { return std::make_tuple(id, occ, cap); }
+};
+
+
+// ------------------------- TOWER (B) -------------------------
+
+struct TowerQueueJoin {
+    static constexpr Ev kind = Ev::TOWER_QUEUE_JOIN;
+    int id;
+    bool vip;
+    int wait_vip;
+    int wait_norm;
+    auto fields() const { return std::make_tuple(id, vip, wait_vip, wait_norm); }
+};
+
+struct TowerEnter {
+    static constexpr Ev kind = Ev::TOWER_ENTER;
+    int id;
+    bool vip;
+    int occ;
+    int cap;
+    int wait_vip;
+    int wait_norm;
+    int vip_streak;
+    auto fields() const { return std::make_tuple(id, vip, occ, cap, wait_vip, wait_norm, vip_streak); }
+};
+
+struct TowerLeave {
+    static constexpr Ev kind = Ev::TOWER_LEAVE;
+    int id;
+    int occ;
+    int cap;
+    auto fields() const { return std::make_tuple(id, occ, cap); }
+};
+
+struct TowerGroupQueueJoin {
+    static constexpr Ev kind = Ev::TOWER_GROUP_QUEUE_JOIN;
+    int gid;
+    int k;
+    bool vip_like;
+    int wait_vip;
+    int wait_norm;
+    auto fields() const { return std::make_tuple(gid, k, vip_like, wait_vip, wait_norm); }
+};
+
+struct TowerGroupEnter {
+    static constexpr Ev kind = Ev::TOWER_GROUP_ENTER;
+    int gid;
+    int k;
+    bool vip_like;
+    int occ;
+    int cap;
+    int wait_vip;
+    int wait_norm;
+    int vip_streak;
+    auto fields() const { return std::make_tuple(gid, k, vip_like, occ, cap, wait_vip, wait_norm, vip_streak); }
+};
+
+struct TowerGroupLeave {
+    static constexpr Ev kind = Ev::TOWER_GROUP_LEAVE;
+    int gid;
+    int k;
+    int occ;
+    int cap;
+    auto fields() const { return std::make_tuple(gid, k, occ, cap); }
+};
+
+struct TowerDenyAge5 {
+    static constexpr Ev kind = Ev::TOWER_DENY_AGE5;
+    int id;
+    auto fields() const { return std::make_tuple(id); }
+};
+
+struct TowerDenyGuardOfU5 {
+    static constexpr Ev kind = Ev::TOWER_DENY_GUARD_OF_U5;
+    int id;
+    auto fields() const { return std::make_tuple(id); }
+};
+
+struct TowerDenyGuardCannot {
+    static constexpr Ev kind = Ev::TOWER_DENY_GUARD_CANNOT;
+    int id;
+    auto fields() const { return std::make_tuple(id); }
+};
+
+struct TowerGroupSkip {
+    static constexpr Ev kind = Ev::TOWER_GROUP_SKIP;
+    int gid;
+    auto fields() const { return std::make_tuple(gid); }
+};
+
+struct TowerEvacuateGroup {
+    static constexpr Ev kind = Ev::TOWER_EVACUATE_GROUP;
+    int gid;
+    int k;
+    auto fields() const { return std::make_tuple(gid, k); }
+};
+
+
+// ------------------------- FERRY (C) -------------------------
+
+struct FerryQueueJoin {
+    static constexpr Ev kind = Ev::FERRY_QUEUE_JOIN;
+    int id;
+    bool vip;
+    Direction dir;
+    int wait_vip;
+    int wait_norm;
+    auto fields() const { return std::make_tuple(id, vip, dir, wait_vip, wait_norm); }
+};
+
+struct FerryBoard {
+    static constexpr Ev kind = Ev::FERRY_BOARD;
+    int id;
+    bool vip;
+    Direction dir;
+    int occ;
+    int cap;
+    int wait_vip;
+    int wait_norm;
+    int vip_streak;
+    auto fields() const { return std::make_tuple(id, vip, dir, occ, cap, wait_vip, wait_norm, vip_streak); }
+};
+
+struct FerryUnboard {
+    static constexpr Ev kind = Ev::FERRY_UNBOARD;
+    int id;
+    int occ;
+    int cap;
+    auto fields() const { return std::make_tuple(id, occ, cap); }
+};
+
+struct FerryGroupQueueJoin {
+    static constexpr Ev kind = Ev::FERRY_GROUP_QUEUE_JOIN;
+    int gid;
+    int k;
+    bool vip_like;
+    Direction dir;
+    int wait_vip;
+    int wait_norm;
+    auto fields() const { return std::make_tuple(gid, k, vip_like, dir, wait_vip, wait_norm); }
+};
+
+struct FerryGroupBoard {
+    static constexpr Ev kind = Ev::FERRY_GROUP_BOARD;
+    int gid;
+    int k;
+    bool vip_like;
+    Direction dir;
+    int occ;
+    int cap;
+    int wait_vip;
+    int wait_norm;
+    int vip_streak;
+    auto fields() const { return std::make_tuple(gid, k, vip_like, dir, occ, cap, wait_vip, wait_norm, vip_streak); }
+};
+
+struct FerryGroupUnboard {
+    static constexpr Ev kind = Ev::FERRY_GROUP_UNBOARD;
+    int gid;
+    int k;
+    int occ;
+    int cap;
+    auto fields() const { return std::make_tuple(gid, k, occ, cap); }
+};
+
+struct FerryGroupSkip {
+    static constexpr Ev kind = Ev::FERRY_GROUP_SKIP;
+    int gid;
+    auto fields() const { return std::make_tuple(gid); }
+};
+
+struct FerryDepart {
+    static constexpr Ev kind = Ev::FERRY_DEPART;
+    int trip;
+    Direction dir;
+    int load;
+    int cap;
+    auto fields() const { return std::make_tuple(trip, dir, load, cap); }
+};
+
+struct FerryArrive {
+    static constexpr Ev kind = Ev::FERRY_ARRIVE;
+    int trip;
+    Direction dir;
+    int unload;
+    auto fields() const { return std::make_tuple(trip, dir, unload); }
+};
+
+
+// ------------------------- TOURIST -------------------------
+
+struct TouristArrive {
+    static constexpr Ev kind = Ev::TOURIST_ARRIVE;
+    int id;
+    int age;
+    bool vip;
+    auto fields() const { return std::make_tuple(id, age, vip); }
+};
+
+struct TouristGroupJoin {
+    static constexpr Ev kind = Ev::TOURIST_GROUP_JOIN;
+    int id;
+    int gid;
+    int guide;
+    auto fields() const { return std::make_tuple(id, gid, guide); }
+};
+
+struct TouristReturnK {
+    static constexpr Ev kind = Ev::TOURIST_RETURN_K;
+    int id;
+    int gid;
+    auto fields() const { return std::make_tuple(id, gid); }
+};
+
+struct TouristLeaveNoEntry {
+    static constexpr Ev kind = Ev::TOURIST_LEAVE_NO_ENTRY;
+    int id;
+    auto fields() const { return std::make_tuple(id); }
+};
+
+struct TouristBalk {
+    static constexpr Ev kind = Ev::TOURIST_BALK;
+    int id;
+    int queued;
+    int cap;
+    auto fields() const { return std::make_tuple(id, queued, cap); }
+};
+
+struct TouristRenege {
+    static constexpr Ev kind = Ev::TOURIST_RENEGE;
+    int id;
+    int waited_ms;
+    auto fields() const { return std::make_tuple(id, waited_ms); }
+};
+
+
+// ------------------------- GUIDE -------------------------
+
+struct GuideStart {
+    static constexpr Ev kind = Ev::GUIDE_START;
+    int guide;
+    auto fields() const { return std::make_tuple(guide); }
+};
+
+struct GuideStop {
+    static constexpr Ev kind = Ev::GUIDE_STOP;
+    int guide;
+    auto fields() const { return std::make_tuple(guide); }
+};
+
+struct GuideGroupStart {
+    static constexpr Ev kind = Ev::GUIDE_GROUP_START;
+    int guide;
+    int gid;
+    int route;
+    auto fields() const { return std::make_tuple(guide, gid, route); }
+};
+
+struct GuideGroupEnd {
+    static constexpr Ev kind = Ev::GUIDE_GROUP_END;
+    int guide;
+    int gid;
+    auto fields() const { return std::make_tuple(guide, gid); }
+};
+
+struct GuideSegment {
+    static constexpr Ev kind = Ev::GUIDE_SEGMENT;
+    char from;
+    char to;
+    int gid;
+    auto fields() const { return std::make_tuple(from, to, gid); }
+};
+
+struct GuideSignal1 {
+    static constexpr Ev kind = Ev::GUIDE_SIGNAL1;
+    int guide;
+    int gid;
+    auto fields() const { return std::make_tuple(guide, gid); }
+};
+
+struct GuideSignal2 {
+    static constexpr Ev kind = Ev::GUIDE_SIGNAL2;
+    int guide;
+    int gid;
+    auto fields() const { return std::make_tuple(guide, gid); }
+};
+
+struct GuideScaleUp {
+    static constexpr Ev kind = Ev::GUIDE_SCALE_UP;
+    int guide;
+    int active;
+    int depth;
+    int oldest_wait_ms;
+    auto fields() const { return std::make_tuple(guide, active, depth, oldest_wait_ms); }
+};
+
+struct GuideScaleDown {
+    static constexpr Ev kind = Ev::GUIDE_SCALE_DOWN;
+    int guide;
+    int active;
+    auto fields() const { return std::make_tuple(guide, active); }
+};
+
+
+// ------------------------- GUARD (opiekunowie) -------------------------
+
+struct GuardDenyNoGuard {
+    static constexpr Ev kind = Ev::GUARD_DENY_NO_GUARD;
+    int id;
+    int age;
+    char where;
+    int gid;
+    auto fields() const { return std::make_tuple(id, age, where, gid); }
+};
+
+struct GuardNone {
+    static constexpr Ev kind = Ev::GUARD_NONE;
+    int child;
+    int age;
+    int gid;
+    auto fields() const { return std::make_tuple(child, age, gid); }
+};
+
+struct GuardAssign {
+    static constexpr Ev kind = Ev::GUARD_ASSIGN;
+    int child;
+    int age;
+    int guardian;
+    int gid;
+    auto fields() const { return std::make_tuple(child, age, guardian, gid); }
+};
+
+struct GuardChildAbortWait {
+    static constexpr Ev kind = Ev::GUARD_CHILD_ABORT_WAIT;
+    int id;
+    char where;
+    int gid;
+    auto fields() const { return std::make_tuple(id, where, gid); }
+};
+
+
+// ------------------------- VIP -------------------------
+
+struct VipDenyChild {
+    static constexpr Ev kind = Ev::VIP_DENY_CHILD;
+    int id;
+    int age;
+    auto fields() const { return std::make_tuple(id, age); }
+};
+
+struct VipStart {
+    static constexpr Ev kind = Ev::VIP_START;
+    int id;
+    int route;
+    auto fields() const { return std::make_tuple(id, route); }
+};
+
+struct VipTowerSkip {
+    static constexpr Ev kind = Ev::VIP_TOWER_SKIP;
+    int id;
+    auto fields() const { return std::make_tuple(id); }
+};
+
+struct VipEnd {
+    static constexpr Ev kind = Ev::VIP_END;
+    int id;
+    auto fields() const { return std::make_tuple(id); }
+};
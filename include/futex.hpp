@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Futex na 32-bitowym słowie w pamięci dzielonej. Bez FUTEX_PRIVATE_FLAG:
+// słowo leży w segmencie mapowanym przez wiele procesów.
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == 4,
+              "futex word must be a plain 32-bit atomic");
+
+/**
+ * @brief Sleep while @p word holds @p expected; EAGAIN/EINTR return at once (callers re-check).
+ */
+inline long futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Wake up to @p n sleepers of @p word; returns how many woke or -1.
+ */
+inline long futex_wake(std::atomic<uint32_t>& word, int n) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, n, nullptr, nullptr, 0);
+}
@@ -1,9 +1,9 @@
 #pragma once
 
-#include <condition_variable>
 #include <mutex>
 #include <vector>
 
+#include "coro.hpp"
 #include "tourist.hpp"
 
 struct GroupControl {
@@ -13,7 +13,7 @@ struct GroupControl {
     int route = 1;
 
     std::mutex mu;
-    std::condition_variable cv;
+    CoCondition cv;                     // wait_step_done() - czeka przewodnik
 
     Step current = Step::NONE;
     bool step_active = false;
@@ -25,19 +25,19 @@ struct GroupControl {
     int bridge_epoch_done = 0;
     bool bridge_in_progress = false;
     int bridge_coordinator_id = -1;
-    std::condition_variable bridge_cv;
+    CoCondition bridge_cv;
 
     // ---- Tower gate (GO_B) ----
     int tower_epoch_done = 0;
     bool tower_in_progress = false;
     int tower_coordinator_id = -1;
-    std::condition_variable tower_cv;
+    CoCondition tower_cv;
 
     // ---- Ferry gate (GO_C) ----
     int ferry_epoch_done = 0;
     bool ferry_in_progress = false;
     int ferry_coordinator_id = -1;
-    std::condition_variable ferry_cv;
+    CoCondition ferry_cv;
 
     /**
      * @brief Construct group control for given group and guide ids.
@@ -106,9 +106,9 @@ struct GroupControl {
     /**
      * @brief Block until all members finished the step.
      */
-    void wait_step_done() {
+    CoTask wait_step_done() {
         std::unique_lock<std::mutex> lk(mu);
-        cv.wait(lk, [&]{ return !step_active; });
+        while (step_active) co_await cv.wait(lk);
     }
 
     // ---- Bridge gate ----
@@ -137,9 +137,9 @@ struct GroupControl {
     /**
      * @brief Wait until bridge epoch is completed by coordinator.
      */
-    void bridge_wait_done(int epoch) {
+    CoTask bridge_wait_done(int epoch) {
         std::unique_lock<std::mutex> lk(mu);
-        bridge_cv.wait(lk, [&]{ return bridge_epoch_done >= epoch; });
+        while (bridge_epoch_done < epoch) co_await bridge_cv.wait(lk);
     }
 
     // ---- Tower gate ----
@@ -168,9 +168,9 @@ struct GroupControl {
     /**
      * @brief Wait until tower epoch is completed by coordinator.
      */
-    void tower_wait_done(int epoch) {
+    CoTask tower_wait_done(int epoch) {
         std::unique_lock<std::mutex> lk(mu);
-        tower_cv.wait(lk, [&]{ return tower_epoch_done >= epoch; });
+        while (tower_epoch_done < epoch) co_await tower_cv.wait(lk);
     }
 
     // ---- Ferry gate ----
@@ -199,8 +199,8 @@ struct GroupControl {
     /**
      * @brief Wait until ferry epoch is completed by coordinator.
      */
-    void ferry_wait_done(int epoch) {
+    CoTask ferry_wait_done(int epoch) {
         std::unique_lock<std::mutex> lk(mu);
-        ferry_cv.wait(lk, [&]{ return ferry_epoch_done >= epoch; });
+        while (ferry_epoch_done < epoch) co_await ferry_cv.wait(lk);
     }
 };
@@ -1,22 +1,73 @@
 #pragma once
 #include <cstdint>
 
-enum class BridgeMsgKind : int32_t { REQ_CROSS = 1, RES_DONE = 2 };
+// REQ_CROSS: wejście (most, wieża) albo przeprawa (prom) - odpowiedź RES_DONE.
+// REQ_LEAVE: zwolnienie miejsca, bez odpowiedzi. REQ_STOP: koniec pracy serwera.
+enum class BridgeMsgKind : int32_t { REQ_CROSS = 1, RES_DONE = 2, REQ_LEAVE = 3, REQ_STOP = 4 };
 
 struct BridgeReqMsg {
     long mtype;
     int32_t kind;
     int32_t tourist_id;
     int32_t tourist_pid;
+    int32_t dir;          // Direction (most, prom)
+    int32_t vip;
+    int32_t k;            // zajmowane miejsca (dziś zawsze 1)
+    int64_t t_ns;         // CLOCK_MONOTONIC wysłania (opóźnienie żądania)
 };
 
 struct BridgeResMsg {
     long mtype;
     int32_t kind;
     int32_t tourist_id;
+    int64_t t_ns;         // CLOCK_MONOTONIC wysłania (opóźnienie odpowiedzi)
 };
 
-class SysVMessageQueue {
+// Kanał żądań i odpowiedzi atrakcji. Dwie implementacje: kolejka SysV
+// (SysVMessageQueue, syscall i kopia w jądrze na komunikat) i pierścień
+// w pamięci dzielonej z futexem (ShmRingChannel, ipc_ring.hpp).
+class MsgChannel {
+public:
+    virtual ~MsgChannel() = default;
+
+    /**
+     * @brief Create the channel for (@p token_path, @p proj_id), dropping anything left from an earlier run.
+     * @return 0 on success, -1 on error
+     */
+    virtual int reset_queue(const char* token_path, int proj_id, int perms = 0600) = 0;
+    /**
+     * @brief Destroy the channel.
+     * @return 0 on success, -1 on error
+     */
+    virtual int remove() = 0;
+
+    /**
+     * @brief Send a prepared request (mtype forced to 1); blocks while the channel is full.
+     */
+    virtual int send_req(const BridgeReqMsg& msg) = 0;
+    /**
+     * @brief Receive the next request, blocking while there is none.
+     */
+    virtual int recv_req(BridgeReqMsg* out) = 0;
+    /**
+     * @brief Receive a request if one is queued.
+     * @return 0 on success, 1 when the channel is empty, -1 on error
+     */
+    virtual int try_recv_req(BridgeReqMsg* out) = 0;
+
+    /**
+     * @brief Send a completion notification to a specific tourist pid.
+     * @param t_ns send time stamped into the reply (0 = none)
+     */
+    virtual int send_done(int tourist_id, int tourist_pid, int64_t t_ns = 0) = 0;
+    /**
+     * @brief Receive the completion notification for this tourist pid.
+     * @param out optional copy of the reply
+     */
+    virtual int recv_done(int tourist_id, int tourist_pid, BridgeResMsg* out = nullptr) = 0;
+};
+
+class SysVMessageQueue : public MsgChannel {
 public:
     /**
      * @brief Create or open a SysV message queue.
@@ -32,30 +83,41 @@ public:
      * @brief Remove the queue (IPC_RMID).
      * @return 0 on success, -1 on error
      */
-    int remove();
+    int remove() override;
 
     /**
      * @brief Force-drop all messages by removing and recreating the queue.
      */
-    int reset_queue(const char* token_path, int proj_id, int perms = 0600);
+    int reset_queue(const char* token_path, int proj_id, int perms = 0600) override;
 
     /**
      * @brief Send a bridge crossing request.
      */
     int send_req(int tourist_id, int tourist_pid);
+    /**
+     * @brief Send a prepared request (mtype forced to 1).
+     */
+    int send_req(const BridgeReqMsg& msg) override;
     /**
      * @brief Receive the next bridge crossing request.
      */
-    int recv_req(BridgeReqMsg* out);
+    int recv_req(BridgeReqMsg* out) override;
+    /**
+     * @brief Receive a request if one is queued (IPC_NOWAIT).
+     * @return 0 on success, 1 when the queue is empty, -1 on error
+     */
+    int try_recv_req(BridgeReqMsg* out) override;
 
     /**
      * @brief Send a completion notification to a specific tourist pid.
+     * @param t_ns send time stamped into the reply (0 = none)
      */
-    int send_done(int tourist_id, int tourist_pid);
+    int send_done(int tourist_id, int tourist_pid, int64_t t_ns = 0) override;
     /**
      * @brief Receive the completion notification for this tourist pid.
+     * @param out optional copy of the reply
      */
-    int recv_done(int tourist_id, int tourist_pid);
+    int recv_done(int tourist_id, int tourist_pid, BridgeResMsg* out = nullptr) override;
 
     /**
      * @brief Get the queue id.
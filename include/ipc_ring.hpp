@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ipc_msg.hpp"
+#include "ipc_shm.hpp"
+
+// Kanał w pamięci dzielonej (--ipc=ring): zamiast msgsnd/msgrcv (syscall
+// i kopia w jądrze na każdy komunikat) pierścień w segmencie SysV shm.
+// - żądania: pierścień MPSC z numerami sekwencji w komórkach (jak MpmcQueue),
+//   wielu turystów wstawia, jeden serwer zdejmuje;
+// - odpowiedzi: skrzynki adresowane pid-em (sondowanie od pid % RING_BOXES),
+//   zajmuje je tylko serwer (jedyny nadawca), zwalnia odbiorca.
+// Do jądra idziemy tylko, gdy trzeba czekać: futex (współdzielony między
+// procesami) na liczniku publikacji / zwolnień, a wake tylko gdy ktoś śpi
+// (flaga czekających, porządek seq_cst jak w MpmcQueue::ready_).
+
+constexpr uint32_t RING_CELLS = 1024;    // potęga dwójki
+constexpr uint32_t RING_BOXES = 4096;
+constexpr uint32_t RING_PROBE = 64;      // długość sondowania skrzynek
+
+/**
+ * @brief Layout of one ring channel in the shared segment.
+ */
+struct RingShared {
+    struct Cell {
+        std::atomic<uint64_t> seq;
+        BridgeReqMsg msg;
+    };
+    struct Mailbox {
+        std::atomic<int32_t> owner;      // pid odbiorcy, 0 = wolna
+        std::atomic<uint32_t> full;      // 1 = odpowiedź gotowa
+        BridgeResMsg msg;
+    };
+    struct Home {
+        std::atomic<uint32_t> seq;       // futex: odpowiedzi dla pid o tym haszu
+        std::atomic<uint32_t> waiters;
+    };
+
+    alignas(64) std::atomic<uint64_t> tail;           // producenci
+    alignas(64) std::atomic<uint64_t> head;           // jedyny konsument
+    alignas(64) std::atomic<uint32_t> items;          // futex: bump po publikacji
+    std::atomic<uint32_t> cons_waiting;
+    alignas(64) std::atomic<uint32_t> space;          // futex: bump po zdjęciu
+    std::atomic<uint32_t> prod_waiting;
+    alignas(64) std::atomic<uint64_t> futex_waits;
+    std::atomic<uint64_t> futex_wakes;
+    Cell cells[RING_CELLS];
+    Mailbox boxes[RING_BOXES];
+    Home homes[RING_BOXES];
+};
+
+class ShmRingChannel : public MsgChannel {
+public:
+    struct Counters {
+        uint64_t futex_waits = 0;   // FUTEX_WAIT wywołane (pusty/pełny pierścień, brak odpowiedzi)
+        uint64_t futex_wakes = 0;   // FUTEX_WAKE wywołane (ktoś czekał)
+    };
+
+    ShmRingChannel() = default;
+    ~ShmRingChannel() override = default;
+
+    ShmRingChannel(const ShmRingChannel&) = delete;
+    ShmRingChannel& operator=(const ShmRingChannel&) = delete;
+
+    /**
+     * @brief Create a fresh zeroed segment for (@p token_path, @p proj_id) and attach it.
+     * @return 0 on success, -1 on error
+     */
+    int reset_queue(const char* token_path, int proj_id, int perms = 0600) override;
+    /**
+     * @brief Detach and remove the segment.
+     * @return 0 on success, -1 on error
+     */
+    int remove() override;
+
+    /**
+     * @brief Publish a request; sleeps on a futex only while the ring is full.
+     */
+    int send_req(const BridgeReqMsg& msg) override;
+    /**
+     * @brief Take the next request; sleeps on a futex only while the ring is empty.
+     */
+    int recv_req(BridgeReqMsg* out) override;
+    /**
+     * @brief Take a request if one is published.
+     * @return 0 on success, 1 when the ring is empty, -1 on error
+     */
+    int try_recv_req(BridgeReqMsg* out) override;
+
+    /**
+     * @brief Put the reply into the mailbox of @p tourist_pid and wake it if it sleeps.
+     */
+    int send_done(int tourist_id, int tourist_pid, int64_t t_ns = 0) override;
+    /**
+     * @brief Wait for the reply in the mailbox of @p tourist_pid and free the mailbox.
+     */
+    int recv_done(int tourist_id, int tourist_pid, BridgeResMsg* out = nullptr) override;
+
+    /**
+     * @brief Futex calls made on this channel by every process so far.
+     */
+    Counters counters() const;
+
+private:
+    SysVSharedMemory shm_;
+    RingShared* r_ = nullptr;
+
+    /**
+     * @brief Vyukov push; false when the ring is full.
+     */
+    bool try_push(const BridgeReqMsg& msg);
+    /**
+     * @brief Vyukov pop (single consumer); false when the head cell is not published yet.
+     */
+    bool try_pop(BridgeReqMsg& out);
+    /**
+     * @brief FUTEX_WAIT on @p word while it still holds @p expected.
+     */
+    void wait(std::atomic<uint32_t>& word, uint32_t expected);
+    /**
+     * @brief FUTEX_WAKE up to @p n sleepers of @p word.
+     */
+    void wake(std::atomic<uint32_t>& word, int n);
+};
+
+/**
+ * @brief Channel backend named by --ipc: "msg" (SysVMessageQueue) or "ring" (ShmRingChannel).
+ */
+std::unique_ptr<MsgChannel> make_msg_channel(const std::string& ipc);
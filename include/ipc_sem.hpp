@@ -1,4 +1,6 @@
 #pragma once
+#include <span>
+
 #include <sys/types.h>
 
 class SysVSemaphore {
@@ -23,15 +25,23 @@ public:
 
     /**
      * @brief Decrement (P) the semaphore.
+     * @param undo SEM_UNDO; pass false when another process does the matching up()
      * @return 0 on success, -1 on error (errno set)
      */
-    int down();
+    int down(bool undo = true);
 
     /**
      * @brief Increment (V) the semaphore.
+     * @param undo SEM_UNDO; pass false when another process did the matching down()
      * @return 0 on success, -1 on error (errno set)
      */
-    int up();
+    int up(bool undo = true);
+
+    /**
+     * @brief Current semaphore value (GETVAL).
+     * @return value, or -1 on error
+     */
+    int value() const;
 
     /**
      * @brief Remove the semaphore (IPC_RMID).
@@ -47,3 +57,101 @@ public:
 private:
     int semid_ = -1;
 };
+
+// Zbiór semaforów SysV. Jedno wywołanie semop zdejmuje k jednostek z jednego
+// lub kilku semaforów naraz - wszystko albo nic, więc dwie grupy nie utkną
+// z częściowo zajętymi miejscami (jak przy k pojedynczych down()).
+struct SemClaim {
+    unsigned short sem;   // numer semafora w zbiorze
+    short k;              // liczba jednostek
+};
+
+class SysVSemaphoreSet {
+public:
+    SysVSemaphoreSet() = default;
+    ~SysVSemaphoreSet() = default;
+
+    /**
+     * @brief Create or open a set of initial.size() semaphores.
+     *
+     * A newly created set gets @p initial (SETALL); an existing one is opened as is.
+     *
+     * @param token_path path to a token file used by ftok
+     * @param proj_id project id for ftok
+     * @param initial initial value of each semaphore
+     * @param perms permission bits (default 0600)
+     * @return 0 on success, -1 on error (errno set)
+     */
+    int create_or_open(const char* token_path, int proj_id, std::span<const int> initial, int perms = 0600);
+
+    /**
+     * @brief Take every claim in one atomic semop, blocking until all fit.
+     * @param undo SEM_UNDO; pass false when another process does the matching release()
+     * @return 0 on success, -1 on error (errno set)
+     */
+    int acquire(std::span<const SemClaim> claims, bool undo = true);
+    /**
+     * @brief Take every claim only if all fit right now (IPC_NOWAIT).
+     * @return 0 on success, 1 when they do not fit, -1 on error
+     */
+    int try_acquire(std::span<const SemClaim> claims, bool undo = true);
+    /**
+     * @brief Like acquire(), giving up after @p timeout_ms (semtimedop).
+     * @return 0 on success, 1 on timeout, -1 on error
+     */
+    int acquire_for(std::span<const SemClaim> claims, int timeout_ms, bool undo = true);
+    /**
+     * @brief Give back every claim in one semop.
+     * @return 0 on success, -1 on error
+     */
+    int release(std::span<const SemClaim> claims, bool undo = true);
+
+    /**
+     * @brief acquire() of @p k units of semaphore @p sem.
+     */
+    int acquire(int sem, int k, bool undo = true);
+    /**
+     * @brief try_acquire() of @p k units of semaphore @p sem.
+     */
+    int try_acquire(int sem, int k, bool undo = true);
+    /**
+     * @brief acquire_for() of @p k units of semaphore @p sem.
+     */
+    int acquire_for(int sem, int k, int timeout_ms, bool undo = true);
+    /**
+     * @brief release() of @p k units of semaphore @p sem.
+     */
+    int release(int sem, int k, bool undo = true);
+
+    /**
+     * @brief Current value of semaphore @p sem (GETVAL).
+     * @return value, or -1 on error
+     */
+    int value(int sem) const;
+
+    /**
+     * @brief Number of semaphores in the set.
+     */
+    int size() const { return nsems_; }
+
+    /**
+     * @brief Remove the whole set (IPC_RMID).
+     * @return 0 on success, -1 on error
+     */
+    int remove();
+
+    /**
+     * @brief Get the semaphore set id.
+     */
+    int id() const { return semid_; }
+
+private:
+    int semid_ = -1;
+    int nsems_ = 0;
+
+    /**
+     * @brief One semop/semtimedop over all claims with sign -1 (take) or +1 (give back).
+     * @return 0 on success, 1 on EAGAIN (busy or timed out), -1 on error
+     */
+    int op(std::span<const SemClaim> claims, int sign, bool undo, bool nowait, int timeout_ms);
+};
@@ -1,16 +1,41 @@
 #pragma once
 
-#include <fstream>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <chrono>
+#include <thread>
+#include <cstdint>
 
-class Logger {
+#include "event_bus.hpp"
+#include "event_log.hpp"
+
+struct LogOptions {
+    bool async = false;          // osobny wątek zapisujący
+    bool binary = false;         // rekordy binarne (event_log.hpp) zamiast tekstu
+    size_t queue_cap = 65536;    // max rekordów czekających na zapis (async, zaokrąglane do potęgi 2)
+    int flush_ms = 50;           // co ile wątek zapisujący opróżnia kolejkę (async)
+};
+
+class Logger : public EventSink {
 public:
     /**
      * @brief Create logger writing to @p path (truncates existing file).
+     *
+     * In async mode a writer thread is started; producers only copy a
+     * fixed-size record into a lock-free ring, the writer formats it.
      */
-    explicit Logger(const std::string& path);
+    explicit Logger(const std::string& path, const LogOptions& opt = LogOptions{});
+
+    /**
+     * @brief Drain pending lines, stop the writer thread and close the file.
+     */
+    ~Logger() override;
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
 
     // log z timestampem od startu loggera
     /**
@@ -27,10 +52,100 @@ public:
      */
     static void log(const std::string& msg);
 
+    /**
+     * @brief EventSink: render the event from its template (or encode it in binary mode).
+     */
+    void on_event(int64_t t_ms, const EventRecord& r) override;
+
+    /**
+     * @brief Write out everything still queued (blocks until written).
+     */
+    void flush();
+
+    /**
+     * @brief Install handlers that drain the global logger on fatal signals.
+     */
+    static void install_signal_drain();
+
 private:
-    std::ofstream out_;
-    std::mutex mu_;
-    std::chrono::steady_clock::time_point t0_;
+    // Rekord kolejki async: stały rozmiar, kopiowany bez alokacji. TEXT (log_ts)
+    // niesie "tag\0msg\0" w bajtach args - w trybie async najwyżej 80 B razem.
+    struct LogRec {
+        int64_t t_ms;
+        EventRecord ev;
+    };
+    struct Cell {
+        std::atomic<uint64_t> seq{0};
+        LogRec rec;
+    };
+
+    int fd_ = -1;
+    LogOptions opt_;
+    std::mutex mu_;                       // sync: zapis; async: tylko usypianie writera i producentów
+    std::atomic<int64_t> last_ms_{0};     // binarnie: czas poprzedniego rekordu w pliku
+
+    // ---- async ----
+    // Pierścień MPMC (schemat Vyukova jak MpmcQueue, ale z rekordem zamiast
+    // std::atomic<T>): producenci to wątki symulacji, zdejmuje writer -
+    // a przy sygnale także handler, bez blokad.
+    std::unique_ptr<Cell[]> ring_;
+    uint64_t mask_ = 0;
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<int> space_waiters_{0};   // producenci czekający na miejsce
+    std::atomic<bool> writer_idle_{false};            // writer śpi na writer_cv_
+
+    // Bufor wyjściowy writera; długości atomowe, więc handler sygnału dopisze resztę.
+    std::unique_ptr<char[]> out_;
+    std::atomic<size_t> out_len_{0};
+    std::atomic<size_t> out_done_{0};
+
+    std::condition_variable writer_cv_;   // budzi wątek zapisujący
+    std::condition_variable space_cv_;    // budzi producentów (pełny pierścień) i flush()
+    uint64_t written_ = 0;                // pozycja pierścienia zapisana do pliku (pod mu_)
+    uint64_t flush_to_ = 0;               // flush(): zapisać co najmniej do tej pozycji
+    bool stop_ = false;
+    std::thread writer_;
 
     static Logger* g_logger_;
+
+    /**
+     * @brief Sync: render and write under mu_. Async: push into the ring.
+     */
+    void emit(const LogRec& r);
+    /**
+     * @brief Render @p r as text or binary into @p out (at most @p cap bytes).
+     *
+     * No allocation, no locks: used by the writer and by the signal handler.
+     * Binary records take their time delta from last_ms_.
+     */
+    size_t render(char* out, size_t cap, const LogRec& r);
+    /**
+     * @brief Vyukov push; false when the ring is full.
+     */
+    bool try_push(const LogRec& r);
+    /**
+     * @brief Vyukov pop; false when the oldest cell is not published yet.
+     */
+    bool try_pop(LogRec& r);
+    /**
+     * @brief Records pushed but not yet taken by the writer.
+     */
+    uint64_t backlog() const;
+    /**
+     * @brief Writer thread: pops, renders into out_, writes in big chunks.
+     */
+    void writer_loop();
+    /**
+     * @brief Write the unwritten part of out_ and empty it.
+     */
+    void write_out();
+    /**
+     * @brief Best-effort drain from a signal handler (atomics, render() and write() only).
+     */
+    void drain_on_signal();
+    /**
+     * @brief Fatal signal handler.
+     */
+    static void on_fatal_signal(int sig);
 };
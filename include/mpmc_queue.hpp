@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// Ograniczona kolejka MPMC bez blokad (pierścień z numerami sekwencji w
+// komórkach, schemat Vyukova). Dodatkowo licznik ready_ pozwala konsumentowi
+// atomowo zarezerwować m elementów naraz (try_claim) i dopiero potem je zdjąć
+// - przewodnik bierze całą grupę albo nic, bez wspólnego mutexa.
+template <class T>
+class MpmcQueue {
+public:
+    /**
+     * @brief Queue holding at least @p capacity elements (rounded up to a power of two).
+     */
+    explicit MpmcQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        mask_ = n - 1;
+        cells_ = std::make_unique<Cell[]>(n);
+        for (size_t i = 0; i < n; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    /**
+     * @brief Append @p v; false when the ring is full.
+     */
+    bool try_push(T v) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* c;
+        while (true) {
+            c = &cells_[pos & mask_];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        c->val.store(v, std::memory_order_relaxed);
+        c->seq.store(pos + 1, std::memory_order_release);
+        ready_.fetch_add(1);   // seq_cst: para z licznikiem śpiących u wołającego
+        return true;
+    }
+
+    /**
+     * @brief Reserve exactly @p m published elements; false if fewer are ready.
+     */
+    bool try_claim(int m) {
+        int r = ready_.load();
+        while (r >= m) {
+            if (ready_.compare_exchange_weak(r, r - m)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Reserve between @p lo and @p hi ready elements (as many as possible); 0 if fewer than @p lo.
+     */
+    int try_claim_upto(int lo, int hi) {
+        int r = ready_.load();
+        while (r >= lo) {
+            int take = r < hi ? r : hi;
+            if (ready_.compare_exchange_weak(r, r - take)) return take;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Reserve every ready element; returns how many.
+     */
+    int claim_all() {
+        return ready_.exchange(0);
+    }
+
+    /**
+     * @brief Pop one element previously reserved with try_claim*()/claim_all().
+     *
+     * The reservation guarantees an element exists; the head slot may still be
+     * written by a producer that took it earlier. A few yields cover the usual
+     * window of a couple of instructions, then we sleep with doubling backoff
+     * (up to kMaxBackoffUs) in case that producer was preempted.
+     */
+    T pop_claimed() {
+        T v;
+        int backoff_us = 1;
+        for (int i = 0; !try_pop(v); ++i) {
+            if (i < kYields) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(backoff_us));
+            backoff_us = std::min(backoff_us * 2, kMaxBackoffUs);
+        }
+        return v;
+    }
+
+    /**
+     * @brief Copy of the oldest element still in the ring (possibly already reserved); false if empty.
+     */
+    bool peek(T& out) const {
+        size_t pos = head_.load(std::memory_order_acquire);
+        const Cell& c = cells_[pos & mask_];
+        if (c.seq.load(std::memory_order_acquire) != pos + 1) return false;
+        out = c.val.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Published, not yet reserved elements.
+     */
+    int ready() const { return ready_.load(); }
+
+private:
+    static constexpr int kYields = 16;
+    static constexpr int kMaxBackoffUs = 1000;
+
+    struct Cell {
+        std::atomic<size_t> seq{0};
+        std::atomic<T> val{};   // atomowe tylko dla peek(); T musi być trywialnie kopiowalne
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<int> ready_{0};
+
+    /**
+     * @brief Pop the oldest element; false when its slot is not published yet.
+     */
+    bool try_pop(T& out) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Cell* c;
+        while (true) {
+            c = &cells_[pos & mask_];
+            size_t seq = c->seq.load(std::memory_order_acquire);
+            intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        out = c->val.load(std::memory_order_relaxed);
+        c->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+};
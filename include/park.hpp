@@ -1,23 +1,28 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <memory>
 #include <mutex>
-#include <random>
 #include <thread>
 #include <vector>
 
 #include "config.hpp"
-#include "logger.hpp"
+#include "coro.hpp"
+#include "event_bus.hpp"
+#include "mpmc_queue.hpp"
 #include "resources.hpp"
+#include "sim_clock.hpp"
 #include "tourist.hpp"   // Step + Tourist
 
 struct Park {
     Config cfg;
-    Logger& log;
+    EventBus& bus;
+    SimClock& clock;
+    Scheduler* sched = nullptr;   // --exec=coro: kasjer, przewodnicy i turyści jako zadania
 
     Bridge bridge;
     Tower tower;
@@ -28,42 +33,154 @@ struct Park {
     std::atomic<int> exited{0};
     std::atomic<int> enqueued{0};
 
-    // Cashier entry queues (VIP has priority).
-    std::mutex entry_mu;
-    std::condition_variable entry_cv;
-    std::deque<Tourist*> entry_vip;
-    std::deque<Tourist*> entry_norm;
+    // Kolejki do kas: shard na kasjera (turysta id % cashiers), VIP mają pierwszeństwo.
+    // Kasjer zabiera naraz do ENTRY_BATCH osób; VIP z cudzych shardów idą przed
+    // zwykłymi z własnego (entry_vips > 0), a pusty kasjer podbiera zwykłych innym.
+    // Bezczynny kasjer ustawia idle - wtedy budzi go też kolejka w cudzym shardzie.
+    struct EntryShard {
+        std::mutex mu;
+        CoCondition cv;
+        std::atomic<bool> idle{false};
+        std::deque<Tourist*> vip;
+        std::deque<Tourist*> norm;
+    };
+    static constexpr int ENTRY_BATCH = 8;
+    std::vector<std::unique_ptr<EntryShard>> entry;
+    std::atomic<int> entry_vips{0};   // VIP czekający we wszystkich shardach
+    std::atomic<int> entry_queued{0};  // wszyscy czekający do kas (limit --entry-cap)
+
+    // --patience-ms: jeden timer na termin najdłużej czekającego; po odpaleniu
+    // zdejmuje z kolejek wszystkich po terminie i uzbraja się na następnego.
+    std::mutex renege_mu;
+    int64_t renege_due = 0;               // termin uzbrojonego timera (0 = brak)
+    SimClock::TimerId renege_timer = 0;
+
+    // Statystyki wejścia: rezygnacje przy pełnej kolejce / po czasie i czekanie na wpuszczenie.
+    struct EntryStats {
+        int admitted = 0;
+        int rejected = 0;   // limit N wyczerpany
+        int balked = 0;     // kolejka pełna przy przyjściu
+        int reneged = 0;    // odeszli po patience_ms
+        int wait_p50_ms = 0, wait_p90_ms = 0, wait_p99_ms = 0, wait_max_ms = 0;
+    };
+    std::mutex entry_stats_mu;
+    EntryStats entry_st;
+    std::vector<int> entry_waits_ms;   // od kolejki do wpuszczenia, per wpuszczony
 
     // Queue for guided groups (non-VIP after entering).
+    // Bez blokad: przewodnik rezerwuje M miejsc jednym CAS (try_claim).
+    // group_mu/group_cv służą tylko do uśpienia przewodnika, gdy czeka < M osób.
+    MpmcQueue<Tourist*> group_q;
+    std::atomic<int> group_sleepers{0};
+    std::atomic<int> group_pending{0};    // wpuszczeni zwykli, jeszcze nie w group_q
+    std::atomic<int> cashiers_live{0};
+    std::atomic<int64_t> group_timer_due{0};   // --group-timeout-ms: termin uzbrojonego timera (0 = brak)
     std::mutex group_mu;
-    std::condition_variable group_cv;
-    std::deque<Tourist*> group_wait;
+    CoCondition group_cv;
+    // --group-policy=compose: okno podglądu zdjęte z group_q (kolejność przyjścia),
+    // z którego przewodnik dobiera skład grupy.
+    std::mutex group_pool_mu;
+    std::deque<Tourist*> group_pool;
+    std::atomic<int> group_pool_n{0};
+
+    // Statystyki formowania grup (--group-timeout-ms: opóźnienie vs wykorzystanie przewodników).
+    struct GroupStats {
+        int full = 0;           // grupy po M
+        int timeout = 0;        // niepełne po przekroczeniu group_timeout_ms
+        int final = 0;          // resztka po zamknięciu parku
+        int members = 0;
+        int wait_p50_ms = 0, wait_p90_ms = 0, wait_p99_ms = 0, wait_max_ms = 0;
+        int64_t guide_busy_ms = 0;   // suma po przewodnikach: od startu grupy do jej końca
+        int64_t guide_duty_ms = 0;   // suma po przewodnikach: od startu do odejścia / końca pracy
+        int guides_peak = 0;
+        int scale_ups = 0;
+        int scale_downs = 0;
+        int slow_groups = 0;    // grupy z dzieckiem < 12 (odcinki x1.5)
+        int guard_none = 0;     // dzieci bez opiekuna w grupie
+    };
+    std::mutex group_stats_mu;
+    GroupStats group_st;
+    std::vector<int> group_waits_ms;   // czas w kolejce każdego członka
+    std::atomic<int> group_denies{0};  // odmowy (DENY) członkom grup na A/B/C
 
-    // Exit reports from guides/VIPs.
+    // Exit reports from guides/VIPs, logged by a separate exit desk (nie czeka na wpuszczanych).
+    struct ExitReport {
+        int id;
+        std::chrono::steady_clock::time_point t;   // chwila report_exit()
+        int64_t t_sim_ms;
+    };
+    struct ExitStats {
+        int logged = 0;
+        int batches = 0;
+        int64_t lat_sum_us = 0;
+        int64_t lat_max_us = 0;
+        int64_t lat_max_sim_ms = 0;
+    };
     std::mutex exit_mu;
-    std::condition_variable exit_cv;
-    std::deque<int> exit_ids;
+    CoCondition exit_cv;
+    std::deque<ExitReport> exit_reports;
+    ExitStats exit_st;
+    bool exit_stop = false;
+    bool exit_done = false;
+    std::condition_variable exit_done_cv;
 
-    // Threads
-    std::thread cashier_thr;
-    std::vector<std::thread> guide_thrs;
+    // Wybór trasy (--route-policy=congestion): średnie kroczące czasów obsługi
+    // (alfa = 1/8, stałoprzecinkowo x16), karmione przez faktycznie wylosowane czasy.
+    struct ServiceEwma {
+        std::atomic<int64_t> v16{-1};
+
+        /**
+         * @brief Fold one sample (ms) into the average.
+         */
+        void add(int64_t ms) {
+            int64_t cur = v16.load();
+            int64_t next;
+            do {
+                next = (cur < 0) ? ms * 16 : cur + (ms * 16 - cur) / 8;
+            } while (!v16.compare_exchange_weak(cur, next));
+        }
+        /**
+         * @brief Average in ms, or @p dflt before the first sample.
+         */
+        int64_t get(int64_t dflt) const {
+            int64_t cur = v16.load();
+            return (cur < 0) ? dflt : cur / 16;
+        }
+    };
+    ServiceEwma bridge_svc_ms;
+    ServiceEwma tower_svc_ms;
+    std::atomic<int> route_picks[2] = {};
+
+    // Elastyczna pula przewodników (--P-max): nadzorca co GUIDE_TICK_MS patrzy na
+    // kolejkę grup, dokłada przewodników (do P_max) i odsyła bezczynnych (do P_min).
+    static constexpr int GUIDE_TICK_MS = 100;
+    std::mutex guides_mu;                 // next_guide_id, guide_thrs, stan nadzorcy
+    int next_guide_id = 0;
+    std::atomic<int> guides_active{0};
+    std::atomic<int> guides_retire{0};    // prośby o odejście dla dodatkowych przewodników
+    std::atomic<bool> sup_stop{false};
+    bool sup_done = false;
+    std::condition_variable sup_done_cv;
 
-    // Random
-    std::mt19937 rng;
-    std::mutex rng_mu;
+    // Threads (--exec=threads)
+    std::vector<std::thread> cashier_thrs;
+    std::vector<std::thread> guide_thrs;
+    std::thread ferry_thr;
+    std::thread sup_thr;
+    std::thread exit_thr;
 
     /**
-     * @brief Construct park with resources configured and bound to logger.
+     * @brief Construct park with resources configured and bound to the event bus.
      */
-    Park(const Config& cfg, Logger& log);
+    Park(const Config& cfg, EventBus& bus);
 
     // Thread lifecycle
     /**
-     * @brief Start cashier and guide threads.
+     * @brief Start cashier, guides and the ferry (threads, or tasks on sched in coro mode).
      */
     void start();
     /**
-     * @brief Stop simulation threads and wake any waiting queues.
+     * @brief Stop simulation threads and the ferry; wake any waiting queues.
      */
     void stop();
     /**
@@ -71,39 +188,74 @@ struct Park {
      */
     void close();
 
-    // Random helpers
+    // Queues
     /**
-     * @brief Uniform integer in [lo, hi].
+     * @brief Enqueue a tourist in its cashier shard (VIP priority).
+     * @return false when --entry-cap waiters are already queued (the tourist balks)
      */
-    int rand_int(int lo, int hi);
+    bool enqueue_entry(Tourist* t);
     /**
-     * @brief Uniform double in [0,1).
+     * @brief Entry counters with admission-wait percentiles.
      */
-    double rand01();
-
-    // Queues
+    EntryStats entry_stats();
     /**
-     * @brief Enqueue a tourist for cashier admission (VIP priority).
+     * @brief Take up to ENTRY_BATCH tourists for cashier @p c (waits until available).
+     * @param out next tourists, VIPs first; empty when the park closed with nothing left
      */
-    void enqueue_entry(Tourist* t);
+    CoTask dequeue_for_cashier(int c, std::vector<Tourist*>& out);
     /**
-     * @brief Dequeue next tourist for the cashier (blocks until available).
+     * @brief Reserve one of the N daily tickets; returns the new count or 0 when sold out.
      */
-    Tourist* dequeue_for_cashier();
+    int try_admit();
 
     /**
      * @brief Enqueue a tourist waiting to form a guided group.
      */
     void enqueue_group_wait(Tourist* t);
     /**
-     * @brief Dequeue exactly M tourists to form a group; blocks until enough.
+     * @brief Claim M tourists (fewer after --group-timeout-ms or at close); sleeps while there is nothing to take.
+     * @param out group members; empty once the park is closed or when an elastic guide was retired
+     * @param may_retire caller is an extra guide that may take a retire request
+     */
+    CoTask dequeue_group(int M, std::vector<Tourist*>& out, bool may_retire = false);
+
+    /**
+     * @brief Tourists waiting for a group: ready in group_q plus the compose window.
+     */
+    int group_avail() const { return group_q.ready() + group_pool_n.load(); }
+    /**
+     * @brief No one else can join the group queue: entry closed, cashiers done, admitted tourists queued.
+     */
+    bool groups_closed() const {
+        return !open.load() && cashiers_live.load() == 0 && group_pending.load() == 0;
+    }
+    /**
+     * @brief group_since_ms of the longest-waiting tourist, or -1 if nobody waits.
+     */
+    int64_t group_oldest_since();
+
+    /**
+     * @brief Group counters with time-in-queue percentiles (call after the guides stopped).
      */
-    std::vector<Tourist*> dequeue_group(int M);
+    GroupStats group_stats();
 
     /**
-     * @brief Report that a tourist exited; cashier thread logs exits.
+     * @brief Pick route 1 or 2 for @p k people by --route-policy (random draws from @p rng).
+     */
+    int choose_route(RngStream& rng, int k, bool vip);
+    /**
+     * @brief Expected time (ms) to pass bridge, tower and ferry on @p route with the current queues.
+     */
+    int64_t route_cost_ms(int route, int k, bool vip);
+
+    /**
+     * @brief Report that a tourist exited; the exit desk logs it.
      */
     void report_exit(int tourist_id);
+    /**
+     * @brief Exit desk counters: logged exits, batches and report-to-log latency.
+     */
+    ExitStats exit_stats();
 
     // KROK SYMULACJI: wykonanie Step przez turystę (guided)
     /**
@@ -112,15 +264,56 @@ struct Park {
      * @param s step to execute
      * @param epoch synchronization epoch inside the group
      */
-    void do_step(Tourist* t, Step s, int epoch);
+    CoTask do_step(Tourist* t, Step s, int epoch);
 
 private:
     /**
-     * @brief Cashier thread loop handling entry and exit logging.
+     * @brief Cashier @p c loop handling entry and exit logging.
+     */
+    CoTask cashier_loop(int c);
+    /**
+     * @brief Move up to @p max tourists from @p q to @p out; shard mutex held.
+     */
+    int take_locked(std::deque<Tourist*>& q, int max, std::vector<Tourist*>& out);
+    /**
+     * @brief Make sure a renege timer fires no later than @p due.
+     */
+    void arm_renege_timer(int64_t due);
+    /**
+     * @brief Drop the renege timer once nobody waits at the cashiers.
+     */
+    void cancel_renege_timer();
+    /**
+     * @brief Remove every waiter past patience_ms, wake them, re-arm for the next one.
+     */
+    void sweep_reneges();
+    /**
+     * @brief Exit desk: wait for reports and emit CASHIER EXIT for each batch until stop().
+     */
+    CoTask exit_desk_loop();
+    /**
+     * @brief Pop @p n claimed members into @p out, record their queue wait and bump @p kind (a group_st counter).
+     */
+    void take_group(int n, std::vector<Tourist*>& out, int& kind);
+    /**
+     * @brief Record queue waits of @p out and bump @p kind; takes group_stats_mu.
+     */
+    void note_group(const std::vector<Tourist*>& out, int& kind);
+    /**
+     * @brief Compose policy: top up the window from group_q and pick a group of @p lo..@p hi from it.
+     */
+    bool compose_group(int lo, int hi, std::vector<Tourist*>& out, int& kind);
+    /**
+     * @brief Guide loop forming groups and driving route steps.
+     * @param elastic extra guide added by the supervisor (retires when idle)
+     */
+    CoTask guide_loop(int guide_id, bool elastic);
+    /**
+     * @brief Start one more guide (thread or task); returns its id. Takes guides_mu.
      */
-    void cashier_loop();
+    int add_guide(bool elastic);
     /**
-     * @brief Guide thread loop forming groups and driving route steps.
+     * @brief Elastic mode: scale guides with group queue depth and oldest wait.
      */
-    void guide_loop(int guide_id);
+    CoTask guide_supervisor();
 };
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <sys/types.h>
+
+#include "attraction_server.hpp"
+#include "config.hpp"
+#include "direction.hpp"
+#include "event_bus.hpp"
+#include "ipc_msg.hpp"
+#include "ipc_ring.hpp"
+#include "ipc_sem.hpp"
+#include "ipc_shm.hpp"
+#include "rng.hpp"
+#include "shm_arena.hpp"
+
+// Tryb wieloprocesowy (--mode=process).
+// Każdy turysta to proces potomny (fork) przechodzący trasę samodzielnie:
+// limit N i liczniki w SharedStats (segment SysV shm, std::atomic_ref),
+// pojemności X1/X2/X3 jako jeden zbiór semaforów SysV. Zajęcie k miejsc to
+// jeden semop, więc partie nie zablokowałyby się na połowie miejsc; dopóki
+// opiekun nie jest osobnym procesem, każdy zajmuje k = 1. Most: jeden kierunek naraz -
+// bramka (turnstile) + "lightswitch" per kierunek, pierwszy wchodzący zajmuje
+// most, ostatni schodzący go zwalnia (bez SEM_UNDO: robią to różne procesy).
+// --attractions=server: zamiast semaforów osobne procesy-arbitrzy atrakcji
+// (attraction_server.hpp), turysta wysyła REQ_CROSS i czeka na RES_DONE;
+// --ipc wybiera kanał: kolejka komunikatów SysV albo pierścień w shm.
+// Cały stan dzielony leży w arenie (shm_arena.hpp): liczniki ProcShared,
+// rekordy obecnych turystów z puli i lista obecnych pod mutexem na futexie
+// (ShmRoster) - kto jest na której atrakcji, bez kopiowania między procesami.
+// Grup i przewodników tu nie ma (tylko --workload=solo); opiekun dziecka nie
+// jest osobnym procesem (więc i reguł DENY opiekunów). Punktem odniesienia jest
+// --mode=inproc --workload=solo, który idzie tą samą trasą co visit(). Prom na
+// semaforach nie ma kursów - każdy płynie sam przez ferry_T_ms (kursy ma tylko
+// serwer promu). main.cpp podaje to w linii [PROCESS].
+// Zdarzenia idą przez ten sam EventBus; Logger (sync, tekst) dzieli z potomkami
+// deskryptor pliku, więc linie się nie mieszają.
+
+/**
+ * @brief Shared segment of a process-mode run; counters are updated with std::atomic_ref.
+ */
+struct ProcShared {
+    SharedStats stats;            // tourists_entered = sprzedane bilety (limit N)
+    uint32_t bridge_on[2];        // osoby w kierunku d (pod semaforem bridge_mx[d])
+    uint64_t rejected;
+    uint64_t tower_visits;
+    uint64_t ferry_rides;
+    uint64_t route_picks[2];
+    uint64_t semops;              // wszystkie semop wykonane przez turystów
+    uint64_t cap_waits;           // zajęcia, które nie zmieściły się od razu (IPC_NOWAIT)
+    ServerStats srv[3];           // --attractions=server, indeks = Attraction
+};
+
+enum class Spot : int32_t { PATH = 0, BRIDGE = 1, TOWER = 2, FERRY = 3 };
+
+/**
+ * @brief Record of a tourist in the park (pool in the arena, linked into ShmRoster).
+ */
+struct ShmTouristRec {
+    int32_t id;
+    int32_t pid;
+    int32_t age;
+    int32_t k;                           // zajmowane miejsca
+    int32_t vip;
+    Spot at;
+    OffsetPtr<ShmTouristRec> prev;
+    OffsetPtr<ShmTouristRec> next;
+};
+
+/**
+ * @brief Tourists currently in the park and where they are; every field under mu.
+ */
+struct ShmRoster {
+    ShmMutex mu;
+    OffsetPtr<ShmTouristRec> head;
+    uint32_t in_park;
+    uint32_t peak_in_park;
+    uint32_t at[4];                      // miejsca zajęte per Spot
+    uint32_t peak_at[4];
+};
+
+class ProcessPark {
+public:
+    struct Stats {
+        int forks = 0;
+        int fork_retries = 0;        // EAGAIN: poczekaliśmy na potomka i ponowili
+        int64_t fork_us_sum = 0;     // czas samego fork() w rodzicu
+        int64_t fork_us_max = 0;
+        int peak_live = 0;
+        int child_failures = 0;      // niezerowy kod wyjścia albo sygnał
+        uint64_t entered = 0;
+        uint64_t exited = 0;
+        uint64_t rejected = 0;
+        uint64_t bridge_crossings = 0;
+        uint64_t tower_visits = 0;
+        uint64_t ferry_rides = 0;
+        uint64_t route_picks[2] = {};
+        uint64_t semops = 0;
+        uint64_t cap_waits = 0;
+        int64_t semop_ns = 0;        // niekontestowany semop (kalibracja przy starcie)
+        bool servers = false;
+        ServerStats srv[3] = {};
+        ShmRingChannel::Counters ring[3] = {};   // --ipc=ring: futex żądań + odpowiedzi
+        // arena
+        size_t arena_used = 0;
+        size_t arena_size = 0;
+        uint32_t recs_capacity = 0;
+        uint32_t recs_peak = 0;
+        uint32_t peak_in_park = 0;
+        uint32_t peak_at[4] = {};
+        uint64_t roster_contended = 0;
+    };
+
+    /**
+     * @brief Create the arena and the attraction semaphores or servers (keys from a per-run token file).
+     */
+    ProcessPark(const Config& cfg, EventBus& bus);
+    /**
+     * @brief Reap every child, then detach and remove the IPC objects.
+     */
+    ~ProcessPark();
+
+    ProcessPark(const ProcessPark&) = delete;
+    ProcessPark& operator=(const ProcessPark&) = delete;
+
+    /**
+     * @brief False when an IPC object could not be created (reason already printed).
+     */
+    bool ok() const { return ok_; }
+
+    /**
+     * @brief Fork the tourist process; on EAGAIN wait for a running one and retry.
+     * @return false when fork() failed for good
+     */
+    bool spawn(int id, int age, bool vip);
+    /**
+     * @brief Collect finished children without blocking.
+     */
+    void reap();
+    /**
+     * @brief Block until every tourist process exited.
+     */
+    void wait_all();
+    /**
+     * @brief Send REQ_STOP to the attraction servers and wait for them (after wait_all()).
+     */
+    void stop_servers();
+
+    /**
+     * @brief Shared counters plus fork/IPC overhead of the run.
+     */
+    Stats stats() const;
+
+private:
+    const Config& cfg_;
+    EventBus& bus_;
+    bool ok_ = false;
+    std::string token_;
+
+    ShmArena arena_;
+    ProcShared* sh_ = nullptr;
+    ShmRoster* roster_ = nullptr;
+    ShmPool<ShmTouristRec>* recs_ = nullptr;
+    ShmTouristRec* me_ = nullptr;    // proces turysty: własny rekord
+
+    enum : int { CAP_BRIDGE = 0, CAP_TOWER = 1, CAP_FERRY = 2 };
+    SysVSemaphoreSet caps_;          // X1, X2, X3
+    SysVSemaphore bridge_turn_;      // bramka: kolejność przychodzenia do mostu
+    SysVSemaphore bridge_empty_;     // 1 = most wolny dla dowolnego kierunku
+    SysVSemaphore bridge_mx_[2];     // chroni bridge_on[d]
+
+    // --attractions=server: kanały żądań i odpowiedzi oraz proces serwera per atrakcja.
+    struct ServerProc {
+        std::unique_ptr<MsgChannel> req;
+        std::unique_ptr<MsgChannel> res;
+        pid_t pid = -1;
+    };
+    bool servers_ = false;
+    ServerProc srv_[3];
+
+    int live_ = 0;
+    Stats st_;
+
+    /**
+     * @brief Open one semaphore of this run; false on error.
+     */
+    bool make_sem(SysVSemaphore& s, int proj_id, int value);
+    /**
+     * @brief Open the capacity set X1/X2/X3; recreate a stale one with other values.
+     */
+    bool make_caps();
+    /**
+     * @brief Time uncontended down/up pairs on a scratch semaphore.
+     */
+    void calibrate();
+    /**
+     * @brief Create the channels of attraction @p a and fork its server.
+     */
+    bool start_server(Attraction a);
+    /**
+     * @brief Reap one child (blocking or not); false when none was collected.
+     */
+    bool reap_one(bool block);
+
+    /**
+     * @brief Counted down() (turysta, proces potomny).
+     */
+    void P(SysVSemaphore& s, bool undo = true);
+    /**
+     * @brief Counted up() (turysta, proces potomny).
+     */
+    void V(SysVSemaphore& s, bool undo = true);
+    /**
+     * @brief Take @p k places of capacity @p cap in one semop (a non-blocking try first, to count waits).
+     */
+    void claim(int cap, int k);
+    /**
+     * @brief Give back @p k places of capacity @p cap in one semop.
+     */
+    void unclaim(int cap, int k);
+    /**
+     * @brief Occupied places of capacity @p cap out of @p total.
+     */
+    int occupied(int cap, int total) const;
+
+    /**
+     * @brief REQ_CROSS for @p k places to the server of @p a and wait for RES_DONE; records latencies.
+     */
+    void call(Attraction a, int id, Direction d, bool vip, int k);
+    /**
+     * @brief REQ_LEAVE of @p k places to the server of @p a (no reply).
+     */
+    void leave(Attraction a, int id, int k);
+
+    /**
+     * @brief Take a record and link it into the roster (after the ticket).
+     */
+    void roster_enter(int id, int age, bool vip, int k);
+    /**
+     * @brief Move this tourist's places to @p spot.
+     */
+    void roster_move(Spot spot);
+    /**
+     * @brief Unlink and free this tourist's record.
+     */
+    void roster_leave();
+
+    /**
+     * @brief Child body: ticket, route over bridge, tower and ferry, exit.
+     */
+    [[noreturn]] void visit(int id, int age, bool vip);
+    /**
+     * @brief Cross the bridge in direction @p d with a party of @p k (one direction at a time, at most X1).
+     */
+    void cross_bridge(int id, Direction d, int k, RngStream& rng);
+    /**
+     * @brief Tower visit of a party of @p k, limited to X2 people.
+     */
+    void visit_tower(int id, bool vip, int k, RngStream& rng);
+    /**
+     * @brief Ferry ride of ferry_T_ms for a party of @p k, at most X3 aboard.
+     */
+    void ride_ferry(int id, bool vip, Direction d, int k);
+};
@@ -1,24 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <mutex>
 #include <string>
+#include <vector>
 
-#include "logger.hpp"
-
-enum class Direction { NONE = 0, FORWARD = 1, BACKWARD = 2 };
-
-/**
- * @brief Convert Direction enum to short string.
- */
-static inline const char* dir_str(Direction d) {
-    switch (d) {
-        case Direction::NONE: return "NONE";
-        case Direction::FORWARD: return "FWD";
-        case Direction::BACKWARD: return "BWD";
-    }
-    return "?";
-}
+#include "coro.hpp"
+#include "direction.hpp"
+#include "event_bus.hpp"
 
 // VIP:
 // - Bridge (A): VIP NIE omija kolejki.
@@ -26,54 +18,154 @@ static inline const char* dir_str(Direction d) {
 
 struct Bridge {
     int cap;
-    Logger& log;
+    EventBus& bus;
+
+    // Stan w jednym słowie: [31] są czekający | [17:16] kierunek | [15:0] liczba osób.
+    // Bez czekających wejście do niepustego mostu w tym samym kierunku i zejście
+    // (nie ostatniej osoby) to jeden CAS; resztę robimy pod mu.
+    static constexpr uint32_t COUNT_MASK = 0xffffu;
+    static constexpr uint32_t DIR_SHIFT  = 16;
+    static constexpr uint32_t WAITERS    = 1u << 31;
+    std::atomic<uint32_t> state{0};
 
     std::mutex mu;
-    std::condition_variable cv;
-    Direction dir = Direction::NONE;
-    int on_bridge = 0;
+
+    // Czekający w kolejności przybycia, osobno dla każdego kierunku.
+    struct Waiter {
+        int tourist_id;
+        Direction d;
+        bool granted = false;    // miejsce przekazane przez zwalniającego
+        CoCondition cv;          // budzony tylko ten jeden czekający
+
+        Waiter(int id, Direction dir) : tourist_id(id), d(dir) {}
+    };
+    std::deque<Waiter*> queue[2];
+    Direction last_dir = Direction::NONE;   // kierunek, który ostatnio opróżnił most
+
+    // Liczniki (benchmark bridge-bench).
+    std::atomic<uint64_t> fast_entries{0};
+    std::atomic<uint64_t> queued_entries{0};
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<int64_t> wait_ns{0};
 
     /**
-     * @brief Construct bridge monitor with capacity and logger.
+     * @brief Construct bridge monitor with capacity and event bus.
      */
-    Bridge(int cap, Logger& log);
+    Bridge(int cap, EventBus& bus);
 
     /**
-     * @brief Enter the bridge, blocking until direction and capacity allow.
+     * @brief Enter the bridge, waiting until direction and capacity allow.
      * @param tourist_id id for logging
      * @param d requested direction
      */
-    void enter(int tourist_id, Direction d);
+    CoTask enter(int tourist_id, Direction d);
     /**
-     * @brief Leave the bridge and release capacity; resets direction when empty.
+     * @brief Leave the bridge and hand freed slots to queued waiters.
      */
     void leave(int tourist_id);
+
+    // Migawka dla wyboru trasy (--route-policy=congestion).
+    struct Snapshot {
+        int count = 0;
+        Direction dir = Direction::NONE;
+        int queued[2] = {};      // czekający: [0] FORWARD, [1] BACKWARD
+    };
+    /**
+     * @brief Current occupancy, direction and per-direction waiters.
+     */
+    Snapshot snapshot();
+
+private:
+    /**
+     * @brief Grant free slots to FIFO waiters of the current (or next) direction; mu held.
+     */
+    void grant_locked();
 };
 
-struct Tower {
-    int cap;
-    Logger& log;
+// Kolejka biletów dla zasobów zajmowanych po k miejsc (Tower, Ferry).
+// Każdy czekający (osoba k=1 albo grupa) dostaje bilet w swojej klasie
+// (VIP / zwykła). Zwalniający sam przydziela miejsca kolejnym biletom i budzi
+// tylko je. Czoło kolejki, które się nie mieści, blokuje resztę - single nie
+// wyprzedzają w nieskończoność dużej grupy.
+struct SlotQueue {
+    struct Ticket {
+        int id;                  // tourist id albo gid
+        int k;
+        bool vip;
+        bool group;
+        Direction d;
+        uint64_t no = 0;         // numer biletu (kolejność przybycia)
+        int64_t t_join = 0;      // czas symulacji dołączenia (statystyki czekania)
+        bool granted = false;
+        CoCondition cv;
 
-    std::mutex mu;
-    std::condition_variable cv;
+        Ticket(int id_, int k_, bool vip_, bool group_, Direction d_)
+            : id(id_), k(k_), vip(vip_), group(group_), d(d_) {}
+    };
 
-    int inside = 0;          // liczba osób w środku
-    int waiting_vip = 0;     // liczba osób VIP czekających
-    int waiting_norm = 0;    // liczba osób normalnych czekających
+    int cap;
+    int used = 0;            // zajęte miejsca
+    int waiting_vip = 0;     // miejsca, na które czekają VIP
+    int waiting_norm = 0;    // miejsca, na które czekają zwykli
 
     int vip_streak = 0;
     static constexpr int VIP_BURST = 5;
 
+    uint64_t next_no = 0;
+    std::deque<Ticket*> vip_q;
+    std::deque<Ticket*> norm_q;
+
+    /**
+     * @brief Queue with @p cap slots.
+     */
+    explicit SlotQueue(int cap_) : cap(cap_) {}
+
+    /**
+     * @brief No ticket waiting in either class.
+     */
+    bool empty() const { return vip_q.empty() && norm_q.empty(); }
+
+    /**
+     * @brief Append a ticket at the end of its class queue; caller holds the monitor mutex.
+     */
+    void join(Ticket* t);
+    /**
+     * @brief Pop the next ticket that may take its slots now (VIP fairness, FIFO), or nullptr.
+     *
+     * Updates used/waiting/vip_streak; the caller logs, sets granted and notifies.
+     */
+    Ticket* next_grant();
+    /**
+     * @brief Pop any class head (VIP first) that fits the free slots, or nullptr.
+     *
+     * For batch loading (Ferry): fills seats the blocked head cannot use.
+     */
+    Ticket* next_fill();
+
+private:
+    /**
+     * @brief Pop the head of @p q and update used/waiting/vip_streak.
+     */
+    Ticket* take(std::deque<Ticket*>& q);
+};
+
+struct Tower {
+    int cap;
+    EventBus& bus;
+
+    std::mutex mu;
+    SlotQueue slots;
+
     /**
-     * @brief Construct tower monitor with capacity and logger.
+     * @brief Construct tower monitor with capacity and event bus.
      */
-    Tower(int cap, Logger& log);
+    Tower(int cap, EventBus& bus);
 
     // per-osoba (VIP path / fallback)
     /**
      * @brief Enter tower as single visitor (handles VIP fairness).
      */
-    void enter(int tourist_id, bool vip);
+    CoTask enter(int tourist_id, bool vip);
     /**
      * @brief Leave tower as single visitor.
      */
@@ -83,49 +175,126 @@ struct Tower {
     /**
      * @brief Enter tower as a group occupying k slots.
      */
-    void enter_group(int group_id, int k, bool vip_like);
+    CoTask enter_group(int group_id, int k, bool vip_like);
     /**
      * @brief Leave tower as a group releasing k slots.
      */
     void leave_group(int group_id, int k);
+
+    struct Snapshot {
+        int used = 0;
+        int waiting_vip = 0;     // miejsca, na które czekają VIP
+        int waiting_norm = 0;
+    };
+    /**
+     * @brief Occupancy and queued slots per class.
+     */
+    Snapshot snapshot();
+
+private:
+    /**
+     * @brief Wait for a ticket to be granted; mu held by @p lk.
+     */
+    CoTask wait_ticket(std::unique_lock<std::mutex>& lk, SlotQueue::Ticket& t);
+    /**
+     * @brief Grant slots to queued tickets and wake them; mu held.
+     */
+    void grant_locked();
 };
 
+// Prom kursuje między dwoma brzegami: [0] - skąd płynie się FORWARD,
+// [1] - skąd płynie się BACKWARD. Aktor promu (run()) zabiera z kolejki
+// swojego brzegu tyle biletów, ile się zmieści (VIP z fairness), płynie
+// cross_ms, wysadza wszystkich na drugim brzegu i tam bierze kolejkę
+// przeciwnego kierunku. Pasażer czeka w ride() aż do wysadzenia.
 struct Ferry {
     int cap;
-    Logger& log;
+    int cross_ms;
+    EventBus& bus;
 
     std::mutex mu;
-    std::condition_variable cv;
+    CoCondition cv;                  // prom czeka na pasażerów (albo stop)
+    SlotQueue slots[2];              // kolejki na brzegach
+    int bank = 0;                    // brzeg, przy którym stoi prom (lub z którego właśnie odpłynął)
+    bool crossing = false;
+    std::vector<SlotQueue::Ticket*> onboard;
 
-    int onboard = 0;         // liczba osób na pokładzie
-    int waiting_vip = 0;
-    int waiting_norm = 0;
+    bool stopping = false;
+    bool stopped = false;
+    std::condition_variable stopped_cv;
 
-    int vip_streak = 0;
-    static constexpr int VIP_BURST = 5;
+    struct Stats {
+        uint64_t trips = 0;
+        uint64_t empty_trips = 0;    // kurs bez pasażerów po czekających z drugiego brzegu
+        uint64_t seats = 0;          // suma zajętych miejsc po wszystkich kursach
+        uint64_t boarded[2] = {};    // bilety per kierunek
+        int64_t wait_ms[2] = {};     // suma czekania na zabranie per kierunek
+        int64_t wait_max_ms[2] = {};
+    };
 
     /**
-     * @brief Construct ferry monitor with capacity and logger.
+     * @brief Construct ferry with capacity, crossing time and event bus.
      */
-    Ferry(int cap, Logger& log);
+    Ferry(int cap, int cross_ms, EventBus& bus);
 
-    // per-osoba (VIP path / fallback)
     /**
-     * @brief Board ferry as single visitor with direction and VIP fairness.
+     * @brief Ferry actor: load on the current bank, cross, unload, repeat until shutdown().
+     */
+    CoTask run();
+    /**
+     * @brief Let run() finish once both banks are empty.
      */
-    void board(int tourist_id, bool vip, Direction d);
+    void shutdown();
     /**
-     * @brief Unboard ferry as single visitor.
+     * @brief Block the calling (non-worker) thread until run() returned.
      */
-    void unboard(int tourist_id);
+    void wait_stopped();
+
+    // per-osoba (VIP path / fallback)
+    /**
+     * @brief Queue on the departure bank of @p d and wait until unloaded on the other side.
+     */
+    CoTask ride(int tourist_id, bool vip, Direction d);
 
     // grupowo (zajęcie k miejsc naraz)
     /**
-     * @brief Board ferry as a group occupying k slots.
+     * @brief Like ride(), for a group occupying k seats on one trip.
+     */
+    CoTask ride_group(int group_id, int k, bool vip_like, Direction d);
+
+    /**
+     * @brief Trip, utilisation and wait counters.
+     */
+    Stats stats();
+
+    struct Snapshot {
+        int bank = 0;
+        bool crossing = false;
+        int waiting_vip[2] = {};     // miejsca czekające na brzegach
+        int waiting_norm[2] = {};
+    };
+    /**
+     * @brief Ferry position and seats queued on each bank.
+     */
+    Snapshot snapshot();
+
+private:
+    Stats st_;
+
+    /**
+     * @brief Queue @p t on its departure bank and wake the ferry; mu held.
+     */
+    SlotQueue& join_locked(SlotQueue::Ticket& t);
+    /**
+     * @brief Wait until the ticket was unloaded at the other bank; mu held by @p lk.
+     */
+    CoTask wait_ticket(std::unique_lock<std::mutex>& lk, SlotQueue::Ticket& t);
+    /**
+     * @brief Board queued tickets of the current bank up to cap; mu held. Returns seats taken.
      */
-    void board_group(int group_id, int k, bool vip_like, Direction d);
+    int load_locked();
     /**
-     * @brief Unboard ferry as a group releasing k slots.
+     * @brief Unload everyone at the arrival bank and wake them; mu held.
      */
-    void unboard_group(int group_id, int k);
+    void unload_locked();
 };
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+// Deterministyczne strumienie losowe per aktor (turysta, przewodnik).
+// Strumień = licznik + mieszanie SplitMix64, ziarno wyprowadzone z
+// (seed, rodzaj aktora, id). Bez blokad: każdy aktor ma własny obiekt,
+// więc te same --seed dają te same decyzje niezależnie od przeplotu wątków.
+class RngStream {
+public:
+    enum Kind : uint64_t { TOURIST = 1, GUIDE = 2, ARRIVAL = 3 };
+
+    /**
+     * @brief Stream for actor (@p kind, @p id) under global @p seed.
+     */
+    RngStream(uint64_t seed, Kind kind, uint64_t id)
+        : key_(mix(mix(seed ^ (static_cast<uint64_t>(kind) << 56)) ^ id)) {}
+
+    /**
+     * @brief Next 64 random bits (counter-based: output i = mix(key + i*gamma)).
+     */
+    uint64_t next() {
+        ctr_ += kGamma;
+        return mix(key_ + ctr_);
+    }
+
+    /**
+     * @brief Uniform integer in [lo, hi] (Lemire multiply-shift with rejection, unbiased).
+     */
+    int uniform_int(int lo, int hi) {
+        if (hi <= lo) return lo;
+        uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1;
+        uint64_t limit = (0 - range) % range;   // 2^64 mod range
+        while (true) {
+            uint64_t x = next();
+            unsigned __int128 m = static_cast<unsigned __int128>(x) * range;
+            if (static_cast<uint64_t>(m) >= limit) {
+                return static_cast<int>(lo + static_cast<int64_t>(m >> 64));
+            }
+        }
+    }
+
+    /**
+     * @brief Uniform double in [0, 1) from the top 53 bits.
+     */
+    double uniform01() {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    static constexpr uint64_t kGamma = 0x9e3779b97f4a7c15ULL;
+
+    uint64_t key_;
+    uint64_t ctr_ = 0;
+
+    /**
+     * @brief SplitMix64 finalizer.
+     */
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
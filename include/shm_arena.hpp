@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "ipc_shm.hpp"
+
+// Arena w segmencie SysV shm dla stanu dzielonego przez procesy.
+// - OffsetPtr: wskaźnik zapisany jako przesunięcie względem własnego adresu,
+//   poprawny w każdym procesie niezależnie od adresu, pod którym segment
+//   jest zamapowany (zwykły wskaźnik byłby ważny tylko w procesie, który go
+//   zapisał);
+// - ShmArena: przydział "bump" bez zwalniania; rekordy wracają do pul;
+// - ShmPool<T>: stała liczba rekordów, wolna lista Treibera z licznikiem
+//   wersji (ABA) w jednym 64-bitowym słowie - przydział bez blokady;
+// - ShmMutex: mutex na futexie (futex.hpp), działa między procesami, bo leży
+//   w segmencie; sekcje pod nim są krótkie i nikt w nich nie czeka na warunek.
+// Właściciel, który zginie z zablokowanym ShmMutex, blokuje resztę - jak przy
+// semaforze bez SEM_UNDO; potomkowie kończą się tylko przez _exit poza sekcjami.
+// Puli rekordów grup ani warunku dzielonego między procesami (czekanie grupy
+// na krok przewodnika) tu nie ma: --mode=process biegnie tylko jako
+// --workload=solo, bez procesów przewodników, więc nie miałyby użytkownika.
+
+/**
+ * @brief Three-state futex mutex (0 free, 1 locked, 2 locked with sleepers).
+ */
+class ShmMutex {
+public:
+    /**
+     * @brief Take the mutex; sleeps in the kernel only under contention.
+     */
+    void lock();
+    /**
+     * @brief Take the mutex if it is free.
+     */
+    bool try_lock();
+    /**
+     * @brief Release; a FUTEX_WAKE only when somebody sleeps.
+     */
+    void unlock();
+    /**
+     * @brief Times lock() had to sleep (contention gauge).
+     */
+    uint64_t contended() const { return contended_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> state_{0};
+    std::atomic<uint64_t> contended_{0};
+};
+
+/**
+ * @brief Self-relative pointer into the same shared segment; 0 = nullptr.
+ */
+template <class T>
+class OffsetPtr {
+public:
+    OffsetPtr() = default;
+    OffsetPtr(T* p) { set(p); }
+    OffsetPtr(const OffsetPtr& o) { set(o.get()); }
+    OffsetPtr& operator=(const OffsetPtr& o) {
+        set(o.get());
+        return *this;
+    }
+    OffsetPtr& operator=(T* p) {
+        set(p);
+        return *this;
+    }
+
+    T* get() const {
+        if (off_ == 0) return nullptr;
+        return reinterpret_cast<T*>(reinterpret_cast<intptr_t>(this) + off_);
+    }
+    T* operator->() const { return get(); }
+    T& operator*() const { return *get(); }
+    explicit operator bool() const { return off_ != 0; }
+
+private:
+    int64_t off_ = 0;
+
+    void set(T* p) {
+        off_ = p ? reinterpret_cast<intptr_t>(p) - reinterpret_cast<intptr_t>(this) : 0;
+    }
+};
+
+class ShmArena {
+public:
+    ShmArena() = default;
+    ~ShmArena() = default;
+
+    ShmArena(const ShmArena&) = delete;
+    ShmArena& operator=(const ShmArena&) = delete;
+
+    /**
+     * @brief Fresh zeroed segment of @p size_bytes (a stale one is dropped), attached.
+     * @return 0 on success, -1 on error
+     */
+    int create(const char* token_path, int proj_id, size_t size_bytes, int perms = 0600);
+    /**
+     * @brief Detach and remove the segment.
+     * @return 0 on success, -1 on error
+     */
+    int remove();
+
+    /**
+     * @brief Carve @p bytes aligned to @p align out of the segment; nullptr when it is full.
+     *
+     * Lock-free (CAS on the top offset), so children may allocate too; nothing is ever freed.
+     */
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    /**
+     * @brief allocate() plus placement new of T(args...); nullptr when full.
+     */
+    template <class T, class... Args>
+    T* construct(Args&&... args) {
+        void* p = allocate(sizeof(T), alignof(T));
+        return p ? new (p) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    /**
+     * @brief Bytes handed out so far (with the header).
+     */
+    size_t used() const;
+    /**
+     * @brief Segment size.
+     */
+    size_t size() const { return size_; }
+
+private:
+    struct Header {
+        std::atomic<uint64_t> top;   // przesunięcie pierwszego wolnego bajtu
+    };
+
+    SysVSharedMemory shm_;
+    Header* h_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Fixed number of T records in an arena; lives in the arena itself (construct it there).
+ */
+template <class T>
+class ShmPool {
+    static_assert(std::is_trivially_destructible_v<T>, "pool records are never destroyed, only recycled");
+
+public:
+    /**
+     * @brief Take @p capacity records from @p arena; capacity() is 0 when it did not fit.
+     */
+    ShmPool(ShmArena& arena, uint32_t capacity) {
+        void* p = arena.allocate(sizeof(Slot) * capacity, alignof(Slot));
+        if (!p) return;
+        Slot* s = static_cast<Slot*>(p);
+        for (uint32_t i = 0; i < capacity; ++i) {
+            new (&s[i]) Slot();
+            s[i].next.store(i + 1 < capacity ? i + 2 : 0, std::memory_order_relaxed);
+        }
+        slots_ = s;
+        cap_ = capacity;
+        head_.store(capacity > 0 ? 1 : 0, std::memory_order_release);
+    }
+
+    ShmPool(const ShmPool&) = delete;
+    ShmPool& operator=(const ShmPool&) = delete;
+
+    /**
+     * @brief Value-initialized record, or nullptr when every record is in use.
+     */
+    T* alloc() {
+        uint64_t h = head_.load(std::memory_order_acquire);
+        while (true) {
+            const uint32_t idx = static_cast<uint32_t>(h);   // 1-based, 0 = pusta lista
+            if (idx == 0) return nullptr;
+            Slot& s = slots_.get()[idx - 1];
+            const uint64_t next = (h & ~0xffffffffULL) + (1ULL << 32) + s.next.load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(h, next, std::memory_order_acq_rel)) {
+                uint32_t n = in_use_.fetch_add(1, std::memory_order_relaxed) + 1;
+                uint32_t pk = peak_.load(std::memory_order_relaxed);
+                while (n > pk && !peak_.compare_exchange_weak(pk, n, std::memory_order_relaxed)) {}
+                return new (&s.val) T();
+            }
+        }
+    }
+
+    /**
+     * @brief Return a record taken with alloc().
+     */
+    void free(T* p) {
+        const auto off = reinterpret_cast<char*>(p) - reinterpret_cast<char*>(slots_.get());
+        const uint32_t idx = static_cast<uint32_t>(off / static_cast<std::ptrdiff_t>(sizeof(Slot))) + 1;
+        Slot* s = &slots_.get()[idx - 1];
+        uint64_t h = head_.load(std::memory_order_relaxed);
+        while (true) {
+            s->next.store(static_cast<uint32_t>(h), std::memory_order_relaxed);
+            const uint64_t nh = (h & ~0xffffffffULL) + (1ULL << 32) + idx;
+            if (head_.compare_exchange_weak(h, nh, std::memory_order_acq_rel)) break;
+        }
+        in_use_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    uint32_t capacity() const { return cap_; }
+    uint32_t in_use() const { return in_use_.load(std::memory_order_relaxed); }
+    uint32_t peak() const { return peak_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Arena bytes needed for a pool of @p capacity records (alignment slack included).
+     */
+    static size_t bytes_for(uint32_t capacity) {
+        return sizeof(ShmPool) + alignof(ShmPool) + sizeof(Slot) * capacity + alignof(Slot);
+    }
+
+private:
+    struct Slot {
+        T val;
+        std::atomic<uint32_t> next{0};   // 1-based indeks następnego wolnego
+    };
+
+    OffsetPtr<Slot> slots_;
+    uint32_t cap_ = 0;
+    std::atomic<uint64_t> head_{0};      // wersja << 32 | indeks wierzchołka (1-based)
+    std::atomic<uint32_t> in_use_{0};
+    std::atomic<uint32_t> peak_{0};
+};
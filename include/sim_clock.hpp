@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+enum class ClockMode { REAL = 0, VIRTUAL = 1 };
+
+// Zegar symulacji.
+// - REAL: zwykłe sleep_for + steady_clock.
+// - VIRTUAL: czas przeskakuje do najbliższej pobudki, gdy wszyscy aktorzy
+//   (wątki symulacji) śpią lub czekają na monitorach. Budzący od razu liczy
+//   budzonego jako działającego, więc przeskok nie zależy od tempa wątków.
+class SimClock {
+public:
+    using TimerId = uint64_t;   // 0 = brak (callback wykonany od razu)
+
+    /**
+     * @brief Process-wide clock used by all simulation actors.
+     */
+    static SimClock& global();
+
+    /**
+     * @brief Select clock mode; call before start() and before any actor runs.
+     */
+    void set_mode(ClockMode m) { mode_ = m; }
+    /**
+     * @brief Current clock mode.
+     */
+    ClockMode mode() const { return mode_; }
+    /**
+     * @brief True when simulated time is used.
+     */
+    bool is_virtual() const { return mode_ == ClockMode::VIRTUAL; }
+
+    /**
+     * @brief Reset time origin and start the virtual-time driver (if virtual).
+     */
+    void start();
+    /**
+     * @brief Stop the virtual-time driver thread.
+     */
+    void stop();
+
+    /**
+     * @brief Milliseconds since start() (real or simulated).
+     */
+    int64_t now_ms();
+
+    /**
+     * @brief Sleep for @p ms of simulation time.
+     */
+    void sleep_ms(int ms);
+
+    /**
+     * @brief Register a new actor; call from the spawning thread before the actor starts.
+     */
+    void actor_spawned();
+    /**
+     * @brief Unregister the calling actor (its thread is about to end).
+     */
+    void actor_finished();
+
+    /**
+     * @brief RAII helper placed at the top of an actor thread body.
+     */
+    struct ActorGuard {
+        SimClock& clk;
+        explicit ActorGuard(SimClock& c) : clk(c) {}
+        ~ActorGuard() { clk.actor_finished(); }
+        ActorGuard(const ActorGuard&) = delete;
+        ActorGuard& operator=(const ActorGuard&) = delete;
+    };
+
+    /**
+     * @brief Run @p fn once @p ms of simulation time have passed.
+     *
+     * Virtual mode: @p fn runs on the driver thread and is handed one held
+     * running unit (see hold()) which it must pass on or release().
+     * Real mode: @p fn runs on an internal timer thread.
+     *
+     * @return id for cancel(), or 0 when @p ms <= 0 and @p fn already ran
+     */
+    TimerId call_after(int ms, std::function<void()> fn);
+    /**
+     * @brief Drop a pending call_after() callback; false if it already ran (or is running).
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief Count @p n units of work (queued coroutines, woken threads) as running.
+     */
+    void hold(int n = 1);
+    /**
+     * @brief Release a unit taken with hold() or handed over by call_after().
+     */
+    void release();
+
+    /**
+     * @brief Mark the calling actor as blocked (virtual mode bookkeeping).
+     *
+     * There is no block_end(): whoever wakes the actor takes its unit with
+     * hold() at notify time (CoCondition::notify_all()), so time cannot move
+     * between the notify and the actor actually running.
+     */
+    void block_begin();
+
+private:
+    ClockMode mode_ = ClockMode::REAL;
+    std::chrono::steady_clock::time_point t0_ = std::chrono::steady_clock::now();
+
+    std::mutex mu_;
+    std::condition_variable tick_cv_;   // sleeperzy czekają na przesunięcie czasu
+    std::condition_variable kick_cv_;   // budzi wątek sterujący
+    int64_t vnow_ = 0;
+    int running_ = 0;                   // aktorzy, którzy nie śpią i nie czekają
+    std::multiset<int64_t> wakeups_;
+    TimerId next_timer_ = 0;
+    std::multimap<int64_t, std::pair<TimerId, std::function<void()>>> vtimers_;
+    bool stop_ = false;
+    std::thread driver_;
+
+    // REAL: wątek timerów dla call_after()
+    std::condition_variable rt_cv_;
+    std::multimap<std::chrono::steady_clock::time_point, std::pair<TimerId, std::function<void()>>> rt_timers_;
+    std::thread rt_timer_;
+
+    /**
+     * @brief Driver loop: advances virtual time when every actor is blocked.
+     */
+    void drive();
+    /**
+     * @brief Real-mode timer thread running call_after() callbacks.
+     */
+    void run_real_timers();
+};
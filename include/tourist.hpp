@@ -1,12 +1,14 @@
 #pragma once
 
 #include <atomic>
-#include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <thread>
 
+#include "coro.hpp"
 #include "resources.hpp"
+#include "rng.hpp"
 
 class Park;
 struct GroupControl;
@@ -28,9 +30,14 @@ public:
 
     Park* park;
 
+    // Własny strumień losowy (seed, id) - bez blokad, powtarzalny dla danego --seed.
+    RngStream rng;
+
     // Grupa / przewodnik
     int group_id = -1;
     int guide_id = -1;
+    std::atomic<int64_t> group_since_ms{0};   // czas dołączenia do kolejki grup (timeout, statystyki)
+    int64_t entry_since_ms = 0;               // czas stanięcia w kolejce do kas (pod mutexem shardu)
     std::shared_ptr<GroupControl> group;
 
     // Spójne przypięcie grupy (bez dereferencji GroupControl w nagłówku!)
@@ -53,11 +60,12 @@ public:
     Tourist(int id_, int age_, bool vip_, Park* park_);
 
     /**
-     * @brief Start the tourist thread.
+     * @brief Start the tourist: own thread, or a task on the park scheduler in coro mode.
+     * @param on_done called as the tourist's very last action (the object may be freed there)
      */
-    void start();
+    void start(std::function<void(Tourist*)> on_done = {});
     /**
-     * @brief Join the tourist thread.
+     * @brief Join the tourist thread (no-op in coro mode, see Scheduler::wait_all()).
      */
     void join();
 
@@ -69,6 +77,10 @@ public:
      * @brief Notify the tourist that cashier rejected them.
      */
     void on_rejected();
+    /**
+     * @brief Notify the tourist that they gave up waiting (--patience-ms) and left the queue.
+     */
+    void on_reneged();
 
     // Group assignment (tu ustawiamy gid/pid – to jest miejsce, gdzie i tak to robisz)
     /**
@@ -92,35 +104,41 @@ public:
     /**
      * @brief Child waits until guardian ready or abort flag.
      */
-    void child_wait_for_guardian_ready(int epoch, const char* where_tag);
+    CoTask child_wait_for_guardian_ready(int epoch, char where);
 
 private:
     std::thread thr;
+    std::function<void(Tourist*)> on_done;
 
     std::mutex mu;
-    std::condition_variable cv;
+    CoCondition cv;
 
     bool admitted = false;
     bool rejected = false;
+    bool reneged = false;
 
     Step next_step = Step::NONE;
     bool step_ready = false;
     int step_epoch = 0;
 
     std::mutex escort_mu;
-    std::condition_variable escort_cv;
+    CoCondition escort_cv;
     int escort_epoch = 0;
 
     /**
-     * @brief Thread body entry point.
+     * @brief Tourist body: admission, then VIP or guided flow.
+     */
+    CoTask run();
+    /**
+     * @brief run(), then on_done (nothing touches the tourist afterwards).
      */
-    void run();
+    CoTask run_and_finish();
     /**
-     * @brief VIP tour flow (unguided).
+     * @brief Unguided tour flow (VIP, or every tourist with --workload=solo).
      */
-    void run_vip();
+    CoTask run_solo();
     /**
      * @brief Guided tour flow (wait for group and follow guide steps).
      */
-    void run_guided();
+    CoTask run_guided();
 };
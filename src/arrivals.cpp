@@ -0,0 +1,206 @@
+#include "arrivals.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "tourist.hpp"
+
+/**
+ * @brief Turn profile weights into per-slot rates with --tourists expected arrivals per day.
+ */
+ArrivalProcess::ArrivalProcess(const Config& cfg)
+    : cfg_(cfg),
+      gaps_(cfg.seed, RngStream::ARRIVAL, 0),
+      demo_(cfg.seed),
+      vip_dist_(cfg.vip_prob) {
+    if (cfg.arrivals == "trace") {
+        in_ = std::fopen(cfg.arrivals_file.c_str(), "rb");
+        if (!in_) {
+            perror(cfg.arrivals_file.c_str());
+            ok_ = false;
+            return;
+        }
+        char hdr[sizeof(TRACE_MAGIC)];
+        binary_ = std::fread(hdr, 1, sizeof(hdr), in_) == sizeof(hdr) &&
+                  std::memcmp(hdr, TRACE_MAGIC, sizeof(hdr)) == 0;
+        if (!binary_) std::rewind(in_);
+        return;
+    }
+    if (cfg.arrivals != "poisson") return;
+
+    std::vector<double> w = cfg.arrival_weights();
+    double sum = 0.0;
+    for (double x : w) sum += x;
+    slot_ms_ = static_cast<double>(cfg.day_ms) / static_cast<double>(w.size());
+    // Oczekiwana liczba przyjść = suma(rate * slot_ms) = tourists_total.
+    for (double x : w) rate_per_ms_.push_back(cfg.tourists_total * x / (sum * slot_ms_));
+}
+
+/**
+ * @brief Close the trace file.
+ */
+ArrivalProcess::~ArrivalProcess() {
+    if (in_) std::fclose(in_);
+}
+
+/**
+ * @brief One binary record or one CSV line; malformed input is counted and skipped.
+ */
+bool ArrivalProcess::read_trace(TraceRecord& r) {
+    if (binary_) {
+        while (std::fread(&r, sizeof(r), 1, in_) == 1) {
+            if (r.age >= 0 && (r.vip == 0 || r.vip == 1)) return true;
+            ++skipped_;
+        }
+        return false;
+    }
+
+    char line[256];
+    while (std::fgets(line, sizeof(line), in_)) {
+        char* p = line;
+        while (*p == ' ' || *p == '\t') ++p;
+        if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') continue;
+
+        long long ts;
+        int age, vip;
+        char tail;
+        int n = std::sscanf(p, "%lld ,%d ,%d %c", &ts, &age, &vip, &tail);
+        if (n == 3 && age >= 0 && (vip == 0 || vip == 1)) {
+            r.ts_ms = ts;
+            r.age = age;
+            r.vip = vip;
+            return true;
+        }
+        // Nagłówek (pierwsza linia bez liczby) nie jest błędem.
+        if (n == 0 && !have_ts0_ && !header_seen_) {
+            header_seen_ = true;
+            continue;
+        }
+        ++skipped_;
+    }
+    return false;
+}
+
+/**
+ * @brief Exponential gap at the current slot's rate; on crossing into the next slot restart there.
+ */
+bool ArrivalProcess::advance() {
+    while (true) {
+        size_t slot = static_cast<size_t>(t_ms_ / slot_ms_);
+        if (slot >= rate_per_ms_.size()) return false;   // po Tk nikt już nie przychodzi
+        double slot_end = static_cast<double>(slot + 1) * slot_ms_;
+        double rate = rate_per_ms_[slot];
+        if (rate > 0.0) {
+            double gap = -std::log(1.0 - gaps_.uniform01()) / rate;
+            if (t_ms_ + gap < slot_end) {
+                t_ms_ += gap;
+                return true;
+            }
+        }
+        t_ms_ = slot_end;
+    }
+}
+
+/**
+ * @brief Burst: --tourists arrivals at t=0. Poisson: next event of the piecewise-constant process.
+ *        Trace: next record, its offset from the first one divided by --replay-speed.
+ */
+bool ArrivalProcess::next(Arrival& a) {
+    if (cfg_.arrivals == "trace") {
+        TraceRecord r;
+        if (!in_ || !read_trace(r)) return false;
+        if (!have_ts0_) {
+            ts0_ = r.ts_ms;
+            have_ts0_ = true;
+        }
+        // Niemalejący czas: rekord z przeszłości odtwarzamy od razu po poprzednim.
+        int64_t at = static_cast<int64_t>(static_cast<double>(r.ts_ms - ts0_) / cfg_.replay_speed);
+        last_ms_ = std::max(last_ms_, at);
+        ++emitted_;
+        a.at_ms = last_ms_;
+        a.age = r.age;
+        a.vip = r.vip != 0;
+        return true;
+    }
+    if (cfg_.arrivals == "poisson") {
+        if (!advance()) return false;
+    } else if (emitted_ >= cfg_.tourists_total) {
+        return false;
+    }
+    ++emitted_;
+    a.at_ms = static_cast<int64_t>(t_ms_);
+    a.age = age_dist_(demo_);
+    a.vip = vip_dist_(demo_);
+    return true;
+}
+
+// ------------------------- Visitors -------------------------
+
+/**
+ * @brief Register and start the tourist; its completion callback hands it back for reaping.
+ */
+void Visitors::start(std::unique_ptr<Tourist> t) {
+    Tourist* raw = t.get();
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        live_.emplace(raw, std::move(t));
+        ++started_;
+        if (static_cast<int>(live_.size()) > peak_) peak_ = static_cast<int>(live_.size());
+    }
+    raw->start([this](Tourist* done) { finished(done); });
+}
+
+/**
+ * @brief Queue a finished tourist for reap().
+ */
+void Visitors::finished(Tourist* t) {
+    std::lock_guard<std::mutex> lk(mu_);
+    done_.push_back(t);
+    cv_.notify_all();
+}
+
+/**
+ * @brief Join and free everything in done_ (outside the lock: join may wait for the thread to end).
+ */
+void Visitors::reap() {
+    std::vector<std::unique_ptr<Tourist>> gone;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        for (Tourist* t : done_) {
+            auto it = live_.find(t);
+            gone.push_back(std::move(it->second));
+            live_.erase(it);
+        }
+        done_.clear();
+    }
+    for (auto& t : gone) t->join();
+}
+
+/**
+ * @brief Reap until nobody is left.
+ */
+void Visitors::wait_all() {
+    while (true) {
+        reap();
+        std::unique_lock<std::mutex> lk(mu_);
+        if (live_.empty()) return;
+        cv_.wait(lk, [&]{ return !done_.empty(); });
+    }
+}
+
+/**
+ * @brief Tourists started so far.
+ */
+int Visitors::started() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return started_;
+}
+
+/**
+ * @brief Peak number of simultaneous visitors.
+ */
+int Visitors::peak_live() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return peak_;
+}
@@ -0,0 +1,253 @@
+#include "attraction_server.hpp"
+
+#include <cerrno>
+#include <ctime>
+
+#include <unistd.h>
+
+#include "events.hpp"
+#include "sim_clock.hpp"
+
+/**
+ * @brief Monotonic nanoseconds; the same clock in every process.
+ */
+int64_t mono_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static int dir_idx(Direction d) { return d == Direction::BACKWARD ? 1 : 0; }
+
+/**
+ * @brief Server state for one attraction; the tower uses slots_[0], the ferry both banks.
+ */
+AttractionServer::AttractionServer(Attraction kind, const Config& cfg, EventBus& bus,
+                                   MsgChannel& req, MsgChannel& res, ServerStats& st)
+    : kind_(kind), cfg_(cfg), bus_(bus), req_(req), res_(res), st_(st),
+      slots_{SlotQueue(kind == Attraction::TOWER ? cfg.X2 : cfg.X3),
+             SlotQueue(kind == Attraction::TOWER ? cfg.X2 : cfg.X3)} {}
+
+/**
+ * @brief Bridge and tower react to requests only; the ferry also sails on its own.
+ */
+void AttractionServer::run() {
+    if (kind_ == Attraction::FERRY) ferry_loop();
+    while (!stop_) {
+        if (!serve_batch()) _exit(1);
+    }
+    _exit(0);
+}
+
+/**
+ * @brief One blocking recv_req (a wakeup), then everything else already queued.
+ */
+bool AttractionServer::serve_batch() {
+    BridgeReqMsg m;
+    if (req_.recv_req(&m) < 0) return errno == EINTR;
+    int64_t t0 = mono_ns();
+    ++st_.wakeups;
+    handle(m);
+    uint64_t n = 1 + drain();
+    if (n > st_.max_batch) st_.max_batch = n;
+    st_.busy_ns += mono_ns() - t0;
+    return true;
+}
+
+/**
+ * @brief try_recv_req until the channel is empty.
+ */
+uint64_t AttractionServer::drain() {
+    BridgeReqMsg m;
+    uint64_t n = 0;
+    while (req_.try_recv_req(&m) == 0) {
+        handle(m);
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * @brief Account the request latency and dispatch by attraction and message kind.
+ */
+void AttractionServer::handle(const BridgeReqMsg& m) {
+    ++st_.reqs;
+    if (m.t_ns > 0) {
+        int64_t lat = mono_ns() - m.t_ns;
+        st_.req_lat_ns_sum += lat;
+        if (lat > st_.req_lat_ns_max) st_.req_lat_ns_max = lat;
+    }
+
+    const auto kind = static_cast<BridgeMsgKind>(m.kind);
+    if (kind == BridgeMsgKind::REQ_STOP) {
+        stop_ = true;
+        return;
+    }
+    const int id = m.tourist_id;
+    const int k = m.k > 0 ? m.k : 1;
+    const Direction d = static_cast<Direction>(m.dir);
+    if (kind == BridgeMsgKind::REQ_CROSS) pid_of_[id] = m.tourist_pid;
+
+    switch (kind_) {
+    case Attraction::BRIDGE:
+        if (kind == BridgeMsgKind::REQ_CROSS) bridge_enter(id, d, k);
+        else bridge_leave(id, k);
+        break;
+
+    case Attraction::TOWER: {
+        SlotQueue& q = slots_[0];
+        if (kind == BridgeMsgKind::REQ_CROSS) {
+            // Bilet żyje od dołączenia do przydziału (tower_grant go zwalnia).
+            auto* t = new SlotQueue::Ticket(id, k, m.vip != 0, false, Direction::NONE);
+            q.join(t);
+            bus_.emit(TowerQueueJoin{id, m.vip != 0, q.waiting_vip, q.waiting_norm});
+        } else {
+            q.used = q.used > k ? q.used - k : 0;
+            bus_.emit(TowerLeave{id, q.used, cfg_.X2});
+        }
+        tower_grant();
+        break;
+    }
+
+    case Attraction::FERRY:
+        if (kind == BridgeMsgKind::REQ_CROSS) {
+            SlotQueue& q = slots_[dir_idx(d)];
+            auto* t = new SlotQueue::Ticket(id, k, m.vip != 0, false, d);
+            t->t_join = SimClock::global().now_ms();
+            q.join(t);
+            bus_.emit(FerryQueueJoin{id, m.vip != 0, d, q.waiting_vip, q.waiting_norm});
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Answer the tourist's REQ_CROSS.
+ */
+void AttractionServer::reply(int id) {
+    auto it = pid_of_.find(id);
+    if (it == pid_of_.end()) return;
+    int pid = it->second;
+    pid_of_.erase(it);
+    res_.send_done(id, pid, mono_ns());
+}
+
+/**
+ * @brief Enter at once when nobody of this direction waits and the bridge is empty or ours with room for @p k.
+ */
+void AttractionServer::bridge_enter(int id, Direction d, int k) {
+    // Jak Bridge::enter(): przy czekającej drugiej stronie nikt nie dochodzi do mostu.
+    bool queues_empty = br_q_[0].empty() && br_q_[1].empty();
+    if (queues_empty && (br_count_ == 0 || br_dir_ == d) && br_count_ + k <= cfg_.X1) {
+        if (br_count_ == 0) {
+            br_dir_ = d;
+            bus_.emit(BridgeDirSet{d});
+        }
+        br_count_ += k;
+        bus_.emit(BridgeEnter{id, d, br_count_, cfg_.X1});
+        reply(id);
+        return;
+    }
+    br_q_[dir_idx(d)].push_back({id, k});
+}
+
+/**
+ * @brief Free the place; an empty bridge goes to the other side first.
+ */
+void AttractionServer::bridge_leave(int id, int k) {
+    br_count_ = br_count_ > k ? br_count_ - k : 0;
+    bus_.emit(BridgeLeave{id, br_count_, cfg_.X1});
+    if (br_count_ == 0) {
+        br_last_ = br_dir_;
+        br_dir_ = Direction::NONE;
+        bus_.emit(BridgeDirSet{Direction::NONE});
+    }
+    bridge_grant();
+}
+
+/**
+ * @brief Same choice as Bridge::grant_locked().
+ */
+void AttractionServer::bridge_grant() {
+    if (br_count_ == 0) {
+        Direction other = (br_last_ == Direction::FORWARD) ? Direction::BACKWARD : Direction::FORWARD;
+        Direction same = (other == Direction::FORWARD) ? Direction::BACKWARD : Direction::FORWARD;
+        if (!br_q_[dir_idx(other)].empty()) br_dir_ = other;
+        else if (!br_q_[dir_idx(same)].empty()) br_dir_ = same;
+        else return;
+        bus_.emit(BridgeDirSet{br_dir_});
+    } else if (!br_q_[1 - dir_idx(br_dir_)].empty()) {
+        return;   // druga strona czeka: most się opróżnia
+    }
+    auto& q = br_q_[dir_idx(br_dir_)];
+    while (!q.empty() && br_count_ + q.front().k <= cfg_.X1) {   // FIFO: partia, która się nie mieści, czeka na czele
+        const BridgeWaiter w = q.front();
+        q.pop_front();
+        br_count_ += w.k;
+        bus_.emit(BridgeEnter{w.id, br_dir_, br_count_, cfg_.X1});
+        reply(w.id);
+    }
+}
+
+/**
+ * @brief Same as Tower::grant_locked(), answering over the queue instead of a condition.
+ */
+void AttractionServer::tower_grant() {
+    SlotQueue& q = slots_[0];
+    while (SlotQueue::Ticket* t = q.next_grant()) {
+        bus_.emit(TowerEnter{t->id, t->vip, q.used, cfg_.X2, q.waiting_vip, q.waiting_norm, q.vip_streak});
+        reply(t->id);
+        delete t;
+    }
+}
+
+/**
+ * @brief Ferry::run() as a process: take new requests between trips, block only when both banks are empty.
+ */
+void AttractionServer::ferry_loop() {
+    std::vector<SlotQueue::Ticket*> onboard;
+    while (true) {
+        int64_t t0 = mono_ns();
+        uint64_t n = drain();
+        if (n > st_.max_batch) st_.max_batch = n;
+        st_.busy_ns += mono_ns() - t0;
+        if (slots_[0].empty() && slots_[1].empty()) {
+            if (stop_) break;
+            if (!serve_batch()) _exit(1);
+            continue;
+        }
+
+        t0 = mono_ns();
+        SlotQueue& q = slots_[bank_];
+        q.used = 0;
+        while (true) {
+            SlotQueue::Ticket* t = q.next_grant();
+            if (!t) t = q.next_fill();
+            if (!t) break;
+            bus_.emit(FerryBoard{t->id, t->vip, t->d, q.used, cfg_.X3, q.waiting_vip,
+                                 q.waiting_norm, q.vip_streak});
+            onboard.push_back(t);
+        }
+        const int load = q.used;
+        const Direction d = bank_ == 0 ? Direction::FORWARD : Direction::BACKWARD;
+        const int trip = static_cast<int>(++trips_);
+        bus_.emit(FerryDepart{trip, d, load, cfg_.X3});
+        st_.busy_ns += mono_ns() - t0;
+
+        SimClock::global().sleep_ms(cfg_.ferry_T_ms);
+
+        t0 = mono_ns();
+        bank_ ^= 1;
+        bus_.emit(FerryArrive{trip, d, load});
+        int occ = load;
+        for (auto* t : onboard) {
+            occ -= t->k;
+            bus_.emit(FerryUnboard{t->id, occ, cfg_.X3});
+            reply(t->id);
+            delete t;
+        }
+        onboard.clear();
+        st_.busy_ns += mono_ns() - t0;
+    }
+    _exit(0);
+}
@@ -0,0 +1,159 @@
+// bridge-bench: porównanie mostu (kolejki per kierunek, budzenie celowane)
+// z dawnym monitorem (jeden cv + notify_all).
+//
+//   bridge-bench [--threads=16] [--iters=2000] [--cap=3] [--cross-us=50]
+//
+// Wątki na zmianę w obu kierunkach wchodzą na most, "przechodzą" cross-us
+// mikrosekund i schodzą. Raport: czas, wybudzenia (w tym puste), średnie
+// i maksymalne czekanie na wejście.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "event_bus.hpp"
+#include "resources.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+// Dawny Bridge: jeden cv, notify_all po każdym wejściu i zejściu.
+struct LegacyBridge {
+    int cap;
+    std::mutex mu;
+    std::condition_variable cv;
+    Direction dir = Direction::NONE;
+    int on_bridge = 0;
+
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<uint64_t> spurious{0};
+
+    explicit LegacyBridge(int c) : cap(c) {}
+
+    void enter(Direction d) {
+        std::unique_lock<std::mutex> lk(mu);
+        auto ok = [&]{ return (dir == Direction::NONE || dir == d) && on_bridge < cap; };
+        while (!ok()) {
+            cv.wait(lk);
+            wakeups.fetch_add(1, std::memory_order_relaxed);
+            if (!ok()) spurious.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (dir == Direction::NONE) dir = d;
+        ++on_bridge;
+        lk.unlock();
+        cv.notify_all();
+    }
+
+    void leave() {
+        std::unique_lock<std::mutex> lk(mu);
+        if (--on_bridge == 0) dir = Direction::NONE;
+        lk.unlock();
+        cv.notify_all();
+    }
+};
+
+struct Result {
+    double wall_ms = 0;
+    uint64_t entries = 0;
+    uint64_t wakeups = 0;
+    uint64_t spurious = 0;
+    double wait_avg_us = 0;
+    double wait_max_us = 0;
+};
+
+/**
+ * @brief Run the crossing workload against enter/leave callables.
+ */
+template <class Enter, class Leave>
+static Result run(int threads, int iters, int cross_us, Enter enter, Leave leave) {
+    std::vector<std::thread> ts;
+    std::vector<double> sum_us(threads, 0.0), max_us(threads, 0.0);
+
+    auto t0 = bench_clock::now();
+    for (int i = 0; i < threads; ++i) {
+        ts.emplace_back([&, i] {
+            Direction d = (i % 2 == 0) ? Direction::FORWARD : Direction::BACKWARD;
+            for (int k = 0; k < iters; ++k) {
+                auto w0 = bench_clock::now();
+                enter(i, d);
+                double us = std::chrono::duration<double, std::micro>(bench_clock::now() - w0).count();
+                sum_us[i] += us;
+                max_us[i] = std::max(max_us[i], us);
+
+                std::this_thread::sleep_for(std::chrono::microseconds(cross_us));
+                leave(i);
+                std::this_thread::sleep_for(std::chrono::microseconds(cross_us / 2));
+            }
+        });
+    }
+    for (auto& t : ts) t.join();
+
+    Result r;
+    r.wall_ms = std::chrono::duration<double, std::milli>(bench_clock::now() - t0).count();
+    r.entries = static_cast<uint64_t>(threads) * static_cast<uint64_t>(iters);
+    double total = 0;
+    for (int i = 0; i < threads; ++i) {
+        total += sum_us[i];
+        r.wait_max_us = std::max(r.wait_max_us, max_us[i]);
+    }
+    r.wait_avg_us = total / static_cast<double>(r.entries);
+    return r;
+}
+
+/**
+ * @brief Print one result row.
+ */
+static void print(const char* name, const Result& r) {
+    std::printf("%-8s wall=%.0fms entries=%llu wakeups=%llu spurious=%llu wait_avg=%.1fus wait_max=%.0fus\n",
+                name, r.wall_ms,
+                static_cast<unsigned long long>(r.entries),
+                static_cast<unsigned long long>(r.wakeups),
+                static_cast<unsigned long long>(r.spurious),
+                r.wait_avg_us, r.wait_max_us);
+}
+
+int main(int argc, char** argv) {
+    int threads = 16, iters = 2000, cap = 3, cross_us = 50;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--threads=", 10) == 0) threads = std::atoi(argv[i] + 10);
+        else if (std::strncmp(argv[i], "--iters=", 8) == 0) iters = std::atoi(argv[i] + 8);
+        else if (std::strncmp(argv[i], "--cap=", 6) == 0) cap = std::atoi(argv[i] + 6);
+        else if (std::strncmp(argv[i], "--cross-us=", 11) == 0) cross_us = std::atoi(argv[i] + 11);
+        else {
+            std::fprintf(stderr, "usage: %s [--threads=N] [--iters=N] [--cap=N] [--cross-us=N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (threads <= 0 || iters <= 0 || cap <= 0 || cross_us < 0) {
+        std::fprintf(stderr, "bridge-bench: arguments must be positive\n");
+        return 2;
+    }
+
+    std::printf("threads=%d iters=%d cap=%d cross_us=%d\n", threads, iters, cap, cross_us);
+
+    LegacyBridge legacy(cap);
+    Result lr = run(threads, iters, cross_us,
+                    [&](int, Direction d) { legacy.enter(d); },
+                    [&](int) { legacy.leave(); });
+    lr.wakeups = legacy.wakeups.load();
+    lr.spurious = legacy.spurious.load();
+    print("monitor", lr);
+
+    EventBus bus;   // bez subskrybentów: emit() nic nie robi
+    Bridge bridge(cap, bus);
+    Result br = run(threads, iters, cross_us,
+                    [&](int id, Direction d) { bridge.enter(id, d).run_inline(); },
+                    [&](int id) { bridge.leave(id); });
+    br.wakeups = bridge.wakeups.load();
+    br.spurious = br.wakeups - std::min(br.wakeups, bridge.queued_entries.load());
+    print("queues", br);
+    std::printf("queues   fast_path=%llu queued=%llu\n",
+                static_cast<unsigned long long>(bridge.fast_entries.load()),
+                static_cast<unsigned long long>(bridge.queued_entries.load()));
+    return 0;
+}
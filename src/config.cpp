@@ -26,9 +26,22 @@ Config Config::from_args(int argc, char** argv) {
         };
 
         if (parse_int("--tourists=", cfg.tourists_total)) continue;
+        if (parse_int("--day-ms=", cfg.day_ms)) continue;
         if (parse_int("--N=", cfg.N)) continue;
         if (parse_int("--M=", cfg.M)) continue;
         if (parse_int("--P=", cfg.P)) continue;
+        if (parse_int("--P-min=", cfg.P_min)) continue;
+        if (parse_int("--P-max=", cfg.P_max)) continue;
+        if (parse_int("--guide-up-depth=", cfg.guide_up_depth)) continue;
+        if (parse_int("--guide-up-wait-ms=", cfg.guide_up_wait_ms)) continue;
+        if (parse_int("--guide-idle-ms=", cfg.guide_idle_ms)) continue;
+        if (parse_int("--cashiers=", cfg.cashiers)) continue;
+        if (parse_int("--cashier-ms=", cfg.cashier_ms)) continue;
+        if (parse_int("--entry-cap=", cfg.entry_cap)) continue;
+        if (parse_int("--patience-ms=", cfg.patience_ms)) continue;
+        if (parse_int("--group-timeout-ms=", cfg.group_timeout_ms)) continue;
+        if (parse_int("--group-min=", cfg.group_min)) continue;
+        if (parse_int("--group-window=", cfg.group_window)) continue;
         if (parse_int("--X1=", cfg.X1)) continue;
         if (parse_int("--X2=", cfg.X2)) continue;
         if (parse_int("--X3=", cfg.X3)) continue;
@@ -42,27 +55,127 @@ Config Config::from_args(int argc, char** argv) {
         if (parse_double("--signal1=", cfg.signal1_prob)) continue;
         if (parse_double("--signal2=", cfg.signal2_prob)) continue;
         if (parse_double("--vip-prob=", cfg.vip_prob)) continue;
+        if (parse_double("--replay-speed=", cfg.replay_speed)) continue;
         if (parse_int("--status-port=", cfg.status_port)) continue;
+        if (parse_int("--log-flush-ms=", cfg.log_flush_ms)) continue;
+        if (parse_int("--log-queue=", cfg.log_queue)) continue;
+        if (parse_int("--stats=", cfg.stats)) continue;
+        if (parse_int("--workers=", cfg.workers)) continue;
         if (std::strncmp(argv[i], "--seed=", 7) == 0) {
             cfg.seed = static_cast<unsigned int>(std::strtoul(argv[i] + 7, nullptr, 10));
             continue;
         }
+        if (std::strncmp(argv[i], "--clock=", 8) == 0) {
+            cfg.clock_mode = argv[i] + 8;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--route-policy=", 15) == 0) {
+            cfg.route_policy = argv[i] + 15;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--arrivals=", 11) == 0) {
+            cfg.arrivals = argv[i] + 11;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--arrivals-file=", 16) == 0) {
+            cfg.arrivals_file = argv[i] + 16;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--arrival-profile=", 18) == 0) {
+            cfg.arrival_profile = argv[i] + 18;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--group-policy=", 15) == 0) {
+            cfg.group_policy = argv[i] + 15;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--exec=", 7) == 0) {
+            cfg.exec = argv[i] + 7;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--mode=", 7) == 0) {
+            cfg.mode = argv[i] + 7;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--attractions=", 14) == 0) {
+            cfg.attractions = argv[i] + 14;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--ipc=", 6) == 0) {
+            cfg.ipc = argv[i] + 6;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--workload=", 11) == 0) {
+            cfg.workload = argv[i] + 11;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--log-mode=", 11) == 0) {
+            cfg.log_mode = argv[i] + 11;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--log-format=", 13) == 0) {
+            cfg.log_format = argv[i] + 13;
+            continue;
+        }
+        if (std::strncmp(argv[i], "--trace=", 8) == 0) {
+            cfg.trace_path = argv[i] + 8;
+            continue;
+        }
     }
+    if (cfg.workload.empty()) cfg.workload = (cfg.mode == "process") ? "solo" : "guided";
     return cfg;
 }
 
+std::vector<double> Config::arrival_weights() const {
+    std::vector<double> w;
+    double sum = 0.0;
+    std::stringstream ss(arrival_profile);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        double v = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || v < 0.0) return {};
+        w.push_back(v);
+        sum += v;
+    }
+    if (sum <= 0.0) return {};
+    return w;
+}
+
 void Config::validate_or_throw() const {
     auto fail = [](const std::string& msg) {
         throw std::runtime_error(msg);
     };
     if (tourists_total <= 0) fail("tourists must be > 0");
+    if (arrivals != "burst" && arrivals != "poisson" && arrivals != "trace") {
+        fail("arrivals must be burst, poisson or trace");
+    }
+    if (arrivals == "trace" && arrivals_file.empty()) fail("arrivals=trace requires --arrivals-file");
+    if (replay_speed <= 0.0) fail("replay-speed must be > 0");
+    if (day_ms <= 0) fail("day-ms must be > 0");
+    if (arrival_weights().empty()) fail("arrival-profile must be comma-separated weights >= 0 with a positive sum");
     if (N <= 0) fail("N must be > 0");
     if (M <= 0) fail("M must be > 0");
     if (P <= 0) fail("P must be > 0");
+    if (P_min < 0 || P_max < 0) fail("P-min/P-max must be >= 0");
+    if (P_max > 0 && P_min > P_max) fail("P-min must be <= P-max");
+    if (P_max == 0 && P_min > 0) fail("P-min requires P-max");
+    if (guide_up_depth < 0) fail("guide-up-depth must be >= 0");
+    if (guide_up_wait_ms <= 0) fail("guide-up-wait-ms must be > 0");
+    if (guide_idle_ms <= 0) fail("guide-idle-ms must be > 0");
+    if (cashiers <= 0) fail("cashiers must be > 0");
+    if (cashier_ms < 0) fail("cashier-ms must be >= 0");
+    if (entry_cap < 0) fail("entry-cap must be >= 0");
+    if (patience_ms < 0) fail("patience-ms must be >= 0");
+    if (group_timeout_ms < 0) fail("group-timeout-ms must be >= 0");
+    if (group_min <= 0 || group_min > M) fail("group-min must be in [1, M]");
+    if (group_policy != "fifo" && group_policy != "compose") fail("group-policy must be fifo or compose");
+    if (group_window != 0 && group_window < M) fail("group-window must be >= M");
     if (X1 <= 0 || X1 >= M) fail("X1 must be in (0, M)");
-    if (X2 <= 0 || X2 >= 2 * M) fail("X2 must be in (0, 2*M)");
+    // Grupa wchodzi na wieżę i prom w całości (k <= M miejsc) - mniejsza pojemność nigdy by jej nie wpuściła.
+    if (X2 < M || X2 >= 2 * M) fail("X2 must be in [M, 2*M)");
     double max_ferry = 1.5 * static_cast<double>(M);
-    if (X3 <= 0 || X3 >= max_ferry) fail("X3 must be in (0, 1.5*M)");
+    if (X3 < M || X3 >= max_ferry) fail("X3 must be in [M, 1.5*M)");
     if (segment_min_ms <= 0 || segment_max_ms < segment_min_ms) fail("segment range invalid");
     if (bridge_min_ms <= 0 || bridge_max_ms < bridge_min_ms) fail("bridge range invalid");
     if (tower_min_ms <= 0 || tower_max_ms < tower_min_ms) fail("tower range invalid");
@@ -70,5 +183,32 @@ void Config::validate_or_throw() const {
     if (signal1_prob < 0.0 || signal1_prob > 1.0) fail("signal1 must be in [0,1]");
     if (signal2_prob < 0.0 || signal2_prob > 1.0) fail("signal2 must be in [0,1]");
     if (vip_prob < 0.0 || vip_prob > 1.0) fail("vip-prob must be in [0,1]");
+    if (route_policy != "random" && route_policy != "congestion") fail("route-policy must be random or congestion");
     if (status_port != -1 && (status_port <= 0 || status_port > 65535)) fail("status-port out of range");
+    if (clock_mode != "real" && clock_mode != "virtual") fail("clock must be real or virtual");
+    if (exec != "threads" && exec != "coro") fail("exec must be threads or coro");
+    if (workers < 0) fail("workers must be >= 0");
+    if (mode != "inproc" && mode != "process") fail("mode must be inproc or process");
+    if (attractions != "sem" && attractions != "server") fail("attractions must be sem or server");
+    if (attractions == "server" && mode != "process") fail("attractions=server requires mode=process");
+    if (ipc != "msg" && ipc != "ring") fail("ipc must be msg or ring");
+    if (ipc == "ring" && attractions != "server") fail("ipc=ring requires attractions=server");
+    if (workload != "guided" && workload != "solo") fail("workload must be guided or solo");
+    if (mode == "process") {
+        if (workload != "solo") fail("mode=process runs only workload=solo (no guide processes)");
+        // Procesy potomne: zegar wirtualny i pula korutyn są per proces, a logger
+        // async (wątek), binarny (delty czasu) i statystyki zdarzeń - w pamięci rodzica.
+        if (clock_mode != "real") fail("mode=process requires clock=real");
+        if (exec != "threads") fail("mode=process requires exec=threads");
+        if (log_mode != "sync" || log_format == "binary") fail("mode=process requires log-mode=sync and a text log");
+        if (stats != 0 || !trace_path.empty() || status_port != -1) {
+            fail("mode=process does not support --stats, --trace or --status-port");
+        }
+    }
+    if (log_mode != "sync" && log_mode != "async") fail("log-mode must be sync or async");
+    if (log_format != "text" && log_format != "binary" && log_format != "none") {
+        fail("log-format must be text, binary or none");
+    }
+    if (log_flush_ms <= 0) fail("log-flush-ms must be > 0");
+    if (log_queue <= 0) fail("log-queue must be > 0");
 }
@@ -0,0 +1,274 @@
+#include "coro.hpp"
+
+#include <algorithm>
+
+static thread_local Scheduler* t_current = nullptr;
+
+/**
+ * @brief Resume the awaiting coroutine, or free a finished root task.
+ */
+std::coroutine_handle<> CoTask::promise_type::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> h) noexcept {
+    auto& p = h.promise();
+    if (p.cont) return p.cont;
+
+    if (Scheduler* s = p.owner) {
+        // Zadanie główne: nikt nie odbierze wyjątku, więc kończymy jak wątek z wyjątkiem.
+        if (p.exc) std::rethrow_exception(p.exc);
+        bool daemon = p.daemon;
+        h.destroy();
+        if (!daemon) s->task_done();
+    }
+    return std::noop_coroutine();
+}
+
+/**
+ * @brief Run to completion on this thread; awaitables block instead of suspending.
+ */
+void CoTask::run_inline() {
+    if (!h_) return;
+    h_.resume();
+    if (!h_.done()) std::terminate();   // poza Schedulerem nic nie powinno się zawiesić
+    if (h_.promise().exc) std::rethrow_exception(h_.promise().exc);
+}
+
+// ------------------------- Scheduler -------------------------
+
+static thread_local int t_worker = -1;   // indeks workera w t_current
+
+/**
+ * @brief Create per-worker deques, then launch the pool.
+ */
+Scheduler::Scheduler(int workers, SimClock& clock)
+    : clock_(clock), t_start_(std::chrono::steady_clock::now()) {
+    if (workers <= 0) workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    workers_.reserve(static_cast<size_t>(workers));
+    for (int i = 0; i < workers; ++i) workers_.push_back(std::make_unique<Worker>());
+    for (int i = 0; i < workers; ++i) workers_[i]->thr = std::thread(&Scheduler::worker_loop, this, i);
+}
+
+/**
+ * @brief Join workers.
+ */
+Scheduler::~Scheduler() {
+    stop();
+}
+
+/**
+ * @brief Scheduler of the calling worker thread.
+ */
+Scheduler* Scheduler::current() {
+    return t_current;
+}
+
+/**
+ * @brief Detach a root task and queue its first step.
+ */
+void Scheduler::spawn(CoTask t) {
+    auto h = t.release();
+    if (!h) return;
+    h.promise().owner = this;
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        ++live_;
+    }
+    schedule(h);
+}
+
+/**
+ * @brief Detach a root task that wait_all() ignores.
+ */
+void Scheduler::spawn_daemon(CoTask t) {
+    auto h = t.release();
+    if (!h) return;
+    h.promise().owner = this;
+    h.promise().daemon = true;
+    schedule(h);
+}
+
+/**
+ * @brief Queue a coroutine, counting it as running for the clock.
+ */
+void Scheduler::schedule(std::coroutine_handle<> h) {
+    clock_.hold();
+    schedule_held(h);
+}
+
+/**
+ * @brief Push to the local deque on a worker, otherwise to the inject queue.
+ */
+void Scheduler::schedule_held(std::coroutine_handle<> h) {
+    if (t_current == this) {
+        Worker& w = *workers_[t_worker];
+        std::lock_guard<std::mutex> lk(w.mu);
+        w.q.push_back(h);
+    } else {
+        std::lock_guard<std::mutex> lk(inject_mu_);
+        inject_.push_back(h);
+    }
+
+    // Para z worker_loop: worker zwiększa idle_ i dopiero potem sprawdza queued_.
+    queued_.fetch_add(1);
+    if (idle_.load() > 0) {
+        std::lock_guard<std::mutex> lk(mu_);
+        cv_.notify_one();
+    }
+}
+
+/**
+ * @brief Root task finished.
+ */
+void Scheduler::task_done() {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (--live_ == 0) done_cv_.notify_all();
+}
+
+/**
+ * @brief Wait for all root tasks.
+ */
+void Scheduler::wait_all() {
+    std::unique_lock<std::mutex> lk(mu_);
+    done_cv_.wait(lk, [&]{ return live_ == 0; });
+}
+
+/**
+ * @brief Ask workers to exit and join them.
+ */
+void Scheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (stop_) return;
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& w : workers_) if (w->thr.joinable()) w->thr.join();
+    t_stop_ = std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Sum per-worker counters.
+ */
+Scheduler::Stats Scheduler::stats() const {
+    Stats st;
+    st.workers = static_cast<int>(workers_.size());
+    int64_t idle_ns = 0;
+    for (auto& w : workers_) {
+        st.tasks += w->tasks.load();
+        st.steals += w->steals.load();
+        idle_ns += w->idle_ns.load();
+    }
+    st.idle_ms = idle_ns / 1000000;
+
+    std::lock_guard<std::mutex> lk(mu_);
+    auto end = stop_ ? t_stop_ : std::chrono::steady_clock::now();
+    st.wall_s = std::chrono::duration<double>(end - t_start_).count();
+    return st;
+}
+
+/**
+ * @brief Local LIFO pop, inject queue, then FIFO steal from the other workers.
+ */
+bool Scheduler::find_work(int idx, std::coroutine_handle<>& h) {
+    Worker& me = *workers_[idx];
+    {
+        std::lock_guard<std::mutex> lk(me.mu);
+        if (!me.q.empty()) {
+            h = me.q.back();
+            me.q.pop_back();
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lk(inject_mu_);
+        if (!inject_.empty()) {
+            h = inject_.front();
+            inject_.pop_front();
+            return true;
+        }
+    }
+
+    int n = static_cast<int>(workers_.size());
+    for (int k = 1; k < n; ++k) {
+        Worker& victim = *workers_[(idx + k) % n];
+        std::lock_guard<std::mutex> lk(victim.mu);
+        if (!victim.q.empty()) {
+            h = victim.q.front();
+            victim.q.pop_front();
+            me.steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Resume ready coroutines; sleep on cv_ when every queue is empty.
+ */
+void Scheduler::worker_loop(int idx) {
+    t_current = this;
+    t_worker = idx;
+    Worker& me = *workers_[idx];
+
+    while (true) {
+        std::coroutine_handle<> h;
+        if (find_work(idx, h)) {
+            queued_.fetch_sub(1);
+            h.resume();
+            me.tasks.fetch_add(1, std::memory_order_relaxed);
+            clock_.release();
+            continue;
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lk(mu_);
+        idle_.fetch_add(1);
+        cv_.wait(lk, [&]{ return stop_ || queued_.load() > 0; });
+        idle_.fetch_sub(1);
+        bool done = stop_ && queued_.load() == 0;
+        lk.unlock();
+        me.idle_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - t0).count(),
+                             std::memory_order_relaxed);
+        if (done) break;
+    }
+
+    t_current = nullptr;
+    t_worker = -1;
+}
+
+// ------------------------- CoCondition -------------------------
+
+/**
+ * @brief Block the calling thread; its clock unit comes back from notify_all(), not from the wakeup.
+ */
+void CoCondition::wait_thread(std::unique_lock<std::mutex>& lk) {
+    SimClock& clk = SimClock::global();
+    if (!clk.is_virtual()) {
+        cv_.wait(lk);
+        return;
+    }
+    const uint64_t e = epoch_;
+    ++thread_waiters_;
+    clk.block_begin();
+    cv_.wait(lk, [&]{ return epoch_ != e; });
+}
+
+/**
+ * @brief Wake blocked threads and queue suspended coroutines.
+ *
+ * Every woken waiter is counted as running here, under the monitor mutex,
+ * so virtual time cannot advance before it gets to run.
+ */
+void CoCondition::notify_all() {
+    if (thread_waiters_ > 0) {
+        SimClock::global().hold(thread_waiters_);
+        thread_waiters_ = 0;
+        ++epoch_;
+    }
+    cv_.notify_all();
+    if (waiters_.empty()) return;
+
+    std::vector<std::pair<Scheduler*, std::coroutine_handle<>>> w;
+    w.swap(waiters_);
+    for (auto& [s, h] : w) s->schedule(h);
+}
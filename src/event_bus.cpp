@@ -0,0 +1,17 @@
+#include "event_bus.hpp"
+#include "sim_clock.hpp"
+
+/**
+ * @brief Register a sink (setup phase only).
+ */
+void EventBus::subscribe(EventSink* s) {
+    if (s) sinks_.push_back(s);
+}
+
+/**
+ * @brief Stamp with simulation time and dispatch.
+ */
+void EventBus::publish(const EventRecord& r) {
+    int64_t t = SimClock::global().now_ms();
+    for (auto* s : sinks_) s->on_event(t, r);
+}
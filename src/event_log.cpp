@@ -0,0 +1,148 @@
+#include "event_log.hpp"
+#include "direction.hpp"
+
+#include <cstring>
+
+/**
+ * @brief Expand the event template with its arguments.
+ */
+std::string ev_format(Ev e, const int64_t* args) {
+    const char* f = ev_schema(e).fmt;
+    std::string out;
+    out.reserve(std::strlen(f) + 32);
+
+    int ai = 0;
+    for (; *f; ++f) {
+        if (*f != '%' || f[1] == '\0') {
+            out += *f;
+            continue;
+        }
+        ++f;
+        switch (*f) {
+            case 'i': out += std::to_string(args[ai++]); break;
+            case 'd': out += dir_str(static_cast<Direction>(args[ai++])); break;
+            case 'c': out += static_cast<char>(args[ai++]); break;
+            default:  out += '%'; out += *f; break;
+        }
+    }
+    return out;
+}
+
+// ------------------------- EvReader -------------------------
+
+/**
+ * @brief Read LEB128 varint; false on EOF or overlong encoding.
+ */
+bool EvReader::get_varint(uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = std::getc(f_);
+        if (c == EOF) return false;
+        v |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) return true;
+    }
+    err_ = "varint too long";
+    return false;
+}
+
+/**
+ * @brief Read zigzag varint.
+ */
+bool EvReader::get_svarint(int64_t& v) {
+    uint64_t u;
+    if (!get_varint(u)) return false;
+    v = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+    return true;
+}
+
+/**
+ * @brief Read length-prefixed string.
+ */
+bool EvReader::get_string(std::string& s) {
+    uint64_t n;
+    if (!get_varint(n)) return false;
+    if (n > EV_MAX_STRING) {
+        err_ = "string length " + std::to_string(n) + " exceeds limit (corrupt record)";
+        return false;
+    }
+    s.resize(n);
+    if (n > 0 && std::fread(&s[0], 1, n, f_) != n) {
+        err_ = "truncated string";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Decode one record; validates file header first time.
+ */
+bool EvReader::next(EvRecord& r) {
+    if (!header_ok_) {
+        char hdr[sizeof(EV_MAGIC)];
+        if (std::fread(hdr, 1, sizeof(hdr), f_) != sizeof(hdr) ||
+            std::memcmp(hdr, EV_MAGIC, sizeof(hdr)) != 0) {
+            err_ = "not a binary park log (bad header)";
+            return false;
+        }
+        header_ok_ = true;
+    }
+
+    // Czysty EOF tylko między rekordami; urwana delta czasu to urwany rekord.
+    int c = std::getc(f_);
+    if (c == EOF) return false;
+    std::ungetc(c, f_);
+    int64_t dt;
+    if (!get_svarint(dt)) {
+        if (err_.empty()) err_ = "truncated record";
+        return false;
+    }
+
+    int type = std::getc(f_);
+    if (type == EOF) {
+        err_ = "truncated record";
+        return false;
+    }
+    if (type >= static_cast<int>(Ev::COUNT)) {
+        err_ = "bad event type";
+        return false;
+    }
+
+    t_ms_ += dt;
+    r.t_ms = t_ms_;
+    r.type = static_cast<Ev>(type);
+
+    if (r.type == Ev::TEXT) {
+        if (!get_string(r.tag) || !get_string(r.msg)) {
+            if (err_.empty()) err_ = "truncated record";
+            return false;
+        }
+        return true;
+    }
+
+    int n = ev_schema(r.type).nargs;
+    for (int i = 0; i < n; ++i) {
+        if (!get_svarint(r.args[i])) {
+            if (err_.empty()) err_ = "truncated record";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Same layout as Logger text output.
+ */
+std::string EvReader::to_text(const EvRecord& r) {
+    std::string line = "t=" + std::to_string(r.t_ms) + "ms ";
+    if (r.type == Ev::TEXT) {
+        line += r.tag;
+        line += ' ';
+        line += r.msg;
+    } else {
+        line += ev_schema(r.type).tag;
+        line += ' ';
+        line += ev_format(r.type, r.args);
+    }
+    line += '\n';
+    return line;
+}
@@ -0,0 +1,169 @@
+#include "event_sinks.hpp"
+
+#include <stdexcept>
+
+// pid w trace: osobna "ścieżka" na każdą atrakcję
+enum TracePid { PID_EVENTS = 0, PID_BRIDGE = 1, PID_TOWER = 2, PID_TOWER_GROUPS = 3,
+                PID_FERRY = 4, PID_FERRY_GROUPS = 5, PID_FERRY_TRIPS = 6 };
+
+// ------------------------- EventStats -------------------------
+
+/**
+ * @brief Atomic max on occupancy, remembering capacity for the report.
+ */
+void EventStats::note_peak(Peak& p, int64_t occ, int64_t cap) {
+    int cur = p.occ.load(std::memory_order_relaxed);
+    while (occ > cur && !p.occ.compare_exchange_weak(cur, static_cast<int>(occ))) {}
+    p.cap.store(static_cast<int>(cap), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Count event; ENTER/BOARD events also update peak occupancy.
+ */
+void EventStats::on_event(int64_t, const EventRecord& r) {
+    counts_[static_cast<size_t>(r.type)].fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(1, std::memory_order_relaxed);
+
+    switch (r.type) {
+        case Ev::BRIDGE_ENTER:      note_peak(bridge_, r.args[2], r.args[3]); break;
+        case Ev::TOWER_ENTER:       note_peak(tower_,  r.args[2], r.args[3]); break;
+        case Ev::TOWER_GROUP_ENTER: note_peak(tower_,  r.args[3], r.args[4]); break;
+        case Ev::FERRY_BOARD:       note_peak(ferry_,  r.args[3], r.args[4]); break;
+        case Ev::FERRY_GROUP_BOARD: note_peak(ferry_,  r.args[4], r.args[5]); break;
+        default: break;
+    }
+}
+
+/**
+ * @brief One-line summary of counters and peaks.
+ */
+void EventStats::print_summary(std::ostream& os) const {
+    auto peak = [](const Peak& p) {
+        return std::to_string(p.occ.load()) + "/" + std::to_string(p.cap.load());
+    };
+    uint64_t denies = count(Ev::GUARD_DENY_NO_GUARD) + count(Ev::TOWER_DENY_AGE5) +
+                      count(Ev::TOWER_DENY_GUARD_OF_U5) + count(Ev::TOWER_DENY_GUARD_CANNOT) +
+                      count(Ev::VIP_DENY_CHILD);
+
+    os << "[EVENTS] total=" << total_.load()
+       << " enter=" << count(Ev::CASHIER_ENTER)
+       << " exit=" << count(Ev::CASHIER_EXIT)
+       << " reject=" << count(Ev::CASHIER_REJECT)
+       << " balk=" << count(Ev::TOURIST_BALK)
+       << " renege=" << count(Ev::TOURIST_RENEGE)
+       << " groups=" << count(Ev::GUIDE_GROUP_START)
+       << " bridge=" << count(Ev::BRIDGE_ENTER)
+       << " tower=" << (count(Ev::TOWER_ENTER) + count(Ev::TOWER_GROUP_ENTER))
+       << " ferry=" << (count(Ev::FERRY_BOARD) + count(Ev::FERRY_GROUP_BOARD))
+       << " deny=" << denies
+       << " signal1=" << count(Ev::GUIDE_SIGNAL1)
+       << " signal2=" << count(Ev::GUIDE_SIGNAL2)
+       << " peak_bridge=" << peak(bridge_)
+       << " peak_tower=" << peak(tower_)
+       << " peak_ferry=" << peak(ferry_)
+       << "\n";
+}
+
+// ------------------------- EventTracer -------------------------
+
+/**
+ * @brief Open trace file and start the JSON array.
+ */
+EventTracer::EventTracer(const std::string& path) {
+    f_ = std::fopen(path.c_str(), "w");
+    if (!f_) throw std::runtime_error("Cannot open trace file: " + path);
+    std::fputs("[\n", f_);
+}
+
+/**
+ * @brief Terminate JSON array and close the file.
+ */
+EventTracer::~EventTracer() {
+    if (!f_) return;
+    std::fputs("\n]\n", f_);
+    std::fclose(f_);
+}
+
+/**
+ * @brief Append one object with separator.
+ */
+void EventTracer::put(const std::string& obj) {
+    if (!first_) std::fputs(",\n", f_);
+    first_ = false;
+    std::fwrite(obj.data(), 1, obj.size(), f_);
+}
+
+/**
+ * @brief Map event to trace records (duration begin/end, counter or instant).
+ */
+void EventTracer::on_event(int64_t t_ms, const EventRecord& r) {
+    const std::string ts = std::to_string(t_ms * 1000);   // trace używa mikrosekund
+
+    auto span = [&](const char* name, char ph, int pid, int64_t tid) {
+        return std::string("{\"name\":\"") + name + "\",\"ph\":\"" + ph +
+               "\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) +
+               ",\"ts\":" + ts + "}";
+    };
+    auto counter = [&](const char* name, int pid, int64_t occ) {
+        return std::string("{\"name\":\"") + name + "\",\"ph\":\"C\",\"pid\":" +
+               std::to_string(pid) + ",\"ts\":" + ts + ",\"args\":{\"occ\":" +
+               std::to_string(occ) + "}}";
+    };
+
+    std::lock_guard<std::mutex> lk(mu_);
+    switch (r.type) {
+        case Ev::BRIDGE_ENTER:
+            put(span("bridge", 'B', PID_BRIDGE, r.args[0]));
+            put(counter("bridge_occ", PID_BRIDGE, r.args[2]));
+            return;
+        case Ev::BRIDGE_LEAVE:
+            put(span("bridge", 'E', PID_BRIDGE, r.args[0]));
+            put(counter("bridge_occ", PID_BRIDGE, r.args[1]));
+            return;
+        case Ev::TOWER_ENTER:
+            put(span("tower", 'B', PID_TOWER, r.args[0]));
+            put(counter("tower_occ", PID_TOWER, r.args[2]));
+            return;
+        case Ev::TOWER_LEAVE:
+            put(span("tower", 'E', PID_TOWER, r.args[0]));
+            put(counter("tower_occ", PID_TOWER, r.args[1]));
+            return;
+        case Ev::TOWER_GROUP_ENTER:
+            put(span("tower_group", 'B', PID_TOWER_GROUPS, r.args[0]));
+            put(counter("tower_occ", PID_TOWER, r.args[3]));
+            return;
+        case Ev::TOWER_GROUP_LEAVE:
+            put(span("tower_group", 'E', PID_TOWER_GROUPS, r.args[0]));
+            put(counter("tower_occ", PID_TOWER, r.args[2]));
+            return;
+        case Ev::FERRY_BOARD:
+            put(span("ferry", 'B', PID_FERRY, r.args[0]));
+            put(counter("ferry_occ", PID_FERRY, r.args[3]));
+            return;
+        case Ev::FERRY_UNBOARD:
+            put(span("ferry", 'E', PID_FERRY, r.args[0]));
+            put(counter("ferry_occ", PID_FERRY, r.args[1]));
+            return;
+        case Ev::FERRY_GROUP_BOARD:
+            put(span("ferry_group", 'B', PID_FERRY_GROUPS, r.args[0]));
+            put(counter("ferry_occ", PID_FERRY, r.args[4]));
+            return;
+        case Ev::FERRY_GROUP_UNBOARD:
+            put(span("ferry_group", 'E', PID_FERRY_GROUPS, r.args[0]));
+            put(counter("ferry_occ", PID_FERRY, r.args[2]));
+            return;
+        case Ev::FERRY_DEPART:
+            put(span("ferry_trip", 'B', PID_FERRY_TRIPS, 0));
+            return;
+        case Ev::FERRY_ARRIVE:
+            put(span("ferry_trip", 'E', PID_FERRY_TRIPS, 0));
+            return;
+        default:
+            break;
+    }
+
+    const EvSchema& sc = ev_schema(r.type);
+    put(std::string("{\"name\":\"") + sc.tag + "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":" +
+        std::to_string(PID_EVENTS) + ",\"tid\":0,\"ts\":" + ts +
+        ",\"args\":{\"msg\":\"" + ev_format(r.type, r.args) + "\"}}");
+}
@@ -0,0 +1,419 @@
+// ipc-bench: kanał żądań i odpowiedzi serwerów atrakcji - kolejka SysV
+// (msgsnd/msgrcv) kontra pierścień w pamięci dzielonej z futexem - oraz
+// zbiór semaforów pojemności z --attractions=sem.
+//
+//   ipc-bench [--clients=4] [--iters=20000] [--backend=all|both|msg|ring|sem]
+//
+// rtt:    klienci (procesy) wysyłają REQ_CROSS i czekają na RES_DONE od
+//         serwera-echa (osobny proces) - jak turysta i serwer atrakcji;
+// oneway: klienci wysyłają REQ_LEAVE bez odpowiedzi, serwer tylko zdejmuje;
+// sem:    klienci zajmują k (1..2) miejsc jednego semafora albo po miejscu
+//         w dwóch naraz (jeden semop): try_acquire, przy braku miejsc
+//         acquire_for z terminem, potem release; licznik w mapowaniu
+//         współdzielonym sprawdza, że zajętość nie przekracza pojemności;
+// groups: dwa procesy-grupy po k = M na zbiorze X1/X2/X3 jak w --mode=process
+//         (2M > X2, X3, więc wykluczają się): na zmianę wieża albo prom
+//         w przeciwnej kolejności i oba naraz jednym semop - bez zakleszczenia.
+// Raport: komunikaty/s oraz RTT avg/p50/p99/max; dla sem zajęcia/s, ile razy
+// zabrakło miejsc, terminy i naruszenia pojemności (musi być 0).
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ipc_ring.hpp"
+#include "ipc_sem.hpp"
+
+/**
+ * @brief CLOCK_MONOTONIC in ns.
+ */
+static int64_t now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Echo server: answer every REQ_CROSS, swallow REQ_LEAVE, exit on REQ_STOP.
+ */
+[[noreturn]] static void serve(MsgChannel& req, MsgChannel& res) {
+    BridgeReqMsg m;
+    while (true) {
+        if (req.recv_req(&m) < 0) {
+            if (errno == EINTR) continue;
+            _exit(1);
+        }
+        const auto kind = static_cast<BridgeMsgKind>(m.kind);
+        if (kind == BridgeMsgKind::REQ_STOP) _exit(0);
+        if (kind == BridgeMsgKind::REQ_CROSS && res.send_done(m.tourist_id, m.tourist_pid, 0) < 0) _exit(1);
+    }
+}
+
+/**
+ * @brief Wait for @p pid; false unless it exited with 0.
+ */
+static bool join(pid_t pid) {
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+struct Result {
+    double wall_ms = 0;
+    double msgs_per_s = 0;
+    double rtt_avg_us = 0;
+    double rtt_p50_us = 0;
+    double rtt_p99_us = 0;
+    double rtt_max_us = 0;
+    bool ok = true;
+};
+
+/**
+ * @brief One run: fork the server and @p clients clients, each doing @p iters calls.
+ */
+static Result run(const std::string& backend, bool rtt, int clients, int iters, const char* token) {
+    Result r;
+    auto req = make_msg_channel(backend);
+    auto res = make_msg_channel(backend);
+    if (req->reset_queue(token, 'q') < 0 || res->reset_queue(token, 'r') < 0) {
+        r.ok = false;
+        return r;
+    }
+
+    // Próbki RTT zapisują procesy potomne - mapowanie współdzielone.
+    const size_t n = static_cast<size_t>(clients) * static_cast<size_t>(iters);
+    void* map = mmap(nullptr, n * sizeof(int64_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap(samples)");
+        r.ok = false;
+        req->remove();
+        res->remove();
+        return r;
+    }
+    int64_t* samples = static_cast<int64_t*>(map);
+
+    pid_t server = fork();
+    if (server < 0) { perror("fork(server)"); std::exit(1); }
+    if (server == 0) serve(*req, *res);
+
+    const int64_t t0 = now_ns();
+    std::vector<pid_t> kids;
+    for (int c = 0; c < clients; ++c) {
+        pid_t pid = fork();
+        if (pid < 0) { perror("fork(client)"); r.ok = false; break; }
+        if (pid == 0) {
+            const int me = static_cast<int>(getpid());
+            const auto kind = rtt ? BridgeMsgKind::REQ_CROSS : BridgeMsgKind::REQ_LEAVE;
+            for (int i = 0; i < iters; ++i) {
+                const int64_t s = now_ns();
+                BridgeReqMsg m{1, static_cast<int32_t>(kind), i, me, 0, 0, 1, s};
+                if (req->send_req(m) < 0) _exit(1);
+                if (rtt) {
+                    while (res->recv_done(i, me, nullptr) < 0) {
+                        if (errno != EINTR) _exit(1);
+                    }
+                    samples[static_cast<size_t>(c) * iters + i] = now_ns() - s;
+                }
+            }
+            _exit(0);
+        }
+        kids.push_back(pid);
+    }
+    for (pid_t k : kids) r.ok = join(k) && r.ok;
+
+    // Kanał jest FIFO: STOP dochodzi po ostatnim żądaniu klientów.
+    BridgeReqMsg stop{1, static_cast<int32_t>(BridgeMsgKind::REQ_STOP), -1, 0, 0, 0, 0, 0};
+    if (req->send_req(stop) < 0) kill(server, SIGTERM);
+    r.ok = join(server) && r.ok;
+    const int64_t t1 = now_ns();
+
+    r.wall_ms = static_cast<double>(t1 - t0) / 1e6;
+    r.msgs_per_s = r.wall_ms > 0 ? static_cast<double>(n) * (rtt ? 2 : 1) * 1000.0 / r.wall_ms : 0.0;
+    if (rtt && r.ok) {
+        std::vector<int64_t> v(samples, samples + n);
+        std::sort(v.begin(), v.end());
+        double sum = 0;
+        for (int64_t x : v) sum += static_cast<double>(x);
+        r.rtt_avg_us = sum / static_cast<double>(n) / 1000.0;
+        r.rtt_p50_us = static_cast<double>(v[n / 2]) / 1000.0;
+        r.rtt_p99_us = static_cast<double>(v[std::min(n - 1, n * 99 / 100)]) / 1000.0;
+        r.rtt_max_us = static_cast<double>(v.back()) / 1000.0;
+    }
+
+    munmap(map, n * sizeof(int64_t));
+    req->remove();
+    res->remove();
+    return r;
+}
+
+struct SemResult {
+    double wall_ms = 0;
+    double claims_per_s = 0;
+    uint64_t busy = 0;         // try_acquire: miejsc brak (1)
+    uint64_t timeouts = 0;     // acquire_for: termin minął (1), potem zwykłe acquire
+    uint64_t violations = 0;   // zajętość ponad pojemność po zajęciu
+    bool ok = true;
+};
+
+/**
+ * @brief Counters of a sem run shared with the client processes.
+ */
+struct SemShared {
+    std::atomic<int> held[3];          // zajęte miejsca per semafor wg klientów
+    std::atomic<uint64_t> busy;
+    std::atomic<uint64_t> timeouts;
+    std::atomic<uint64_t> violations;
+};
+
+constexpr int SEM_CAP = 3;             // pojemność każdego z dwóch semaforów
+constexpr int SEM_TIMEOUT_MS = 2;      // krótki termin, żeby ścieżka timeoutu też się wykonała
+constexpr int PARK_M = 5;              // domyślne M i X1..X3 z Config
+constexpr int PARK_CAPS[3] = {3, 8, 7};
+
+/**
+ * @brief try_acquire, then acquire_for with a deadline, then a plain acquire; counts the slow paths.
+ */
+static int take(SysVSemaphoreSet& set, std::span<const SemClaim> claims, SemShared* sh) {
+    int rc = set.try_acquire(claims);
+    if (rc == 1) {
+        sh->busy.fetch_add(1, std::memory_order_relaxed);
+        rc = set.acquire_for(claims, SEM_TIMEOUT_MS);
+        if (rc == 1) {
+            sh->timeouts.fetch_add(1, std::memory_order_relaxed);
+            rc = set.acquire(claims);
+        }
+    }
+    return rc;
+}
+
+/**
+ * @brief Count the claimed places in held[]; a sum over @p caps is a violation.
+ */
+static void hold(std::span<const SemClaim> claims, const int* caps, SemShared* sh) {
+    for (const SemClaim& x : claims) {
+        if (sh->held[x.sem].fetch_add(x.k) + x.k > caps[x.sem]) sh->violations.fetch_add(1);
+    }
+}
+
+/**
+ * @brief Undo hold().
+ */
+static void unhold(std::span<const SemClaim> claims, SemShared* sh) {
+    for (const SemClaim& x : claims) sh->held[x.sem].fetch_sub(x.k);
+}
+
+/**
+ * @brief Expected results with the set fully taken: try_acquire busy, acquire_for times out.
+ */
+static bool sem_selftest(SysVSemaphoreSet& set) {
+    if (set.acquire(0, SEM_CAP) != 0) return false;
+    bool ok = set.try_acquire(0, 1) == 1;
+    const int64_t t0 = now_ns();
+    ok = set.acquire_for(0, 1, 20) == 1 && ok;
+    ok = now_ns() - t0 >= 20 * 1000000LL && ok;
+    // Dwa semafory naraz: drugi pełny, więc pierwszy też nie może zostać zajęty.
+    const SemClaim both[2] = {{1, 1}, {0, 1}};
+    ok = set.try_acquire(both) == 1 && set.value(1) == SEM_CAP && ok;
+    return set.release(0, SEM_CAP) == 0 && ok;
+}
+
+/**
+ * @brief Capacity claims of @p clients processes, @p iters each, on a fresh two-semaphore set.
+ */
+static SemResult run_sem(int clients, int iters, const char* token) {
+    SemResult r;
+    SysVSemaphoreSet set;
+    const int caps[2] = {SEM_CAP, SEM_CAP};
+    if (set.create_or_open(token, 's', caps) < 0 || set.remove() < 0 || set.create_or_open(token, 's', caps) < 0) {
+        r.ok = false;
+        return r;
+    }
+    if (!sem_selftest(set)) {
+        std::fprintf(stderr, "ipc-bench: sem self-test failed\n");
+        r.ok = false;
+    }
+
+    void* map = mmap(nullptr, sizeof(SemShared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap(sem)");
+        set.remove();
+        r.ok = false;
+        return r;
+    }
+    SemShared* sh = new (map) SemShared();
+
+    const int64_t t0 = now_ns();
+    std::vector<pid_t> kids;
+    for (int c = 0; c < clients; ++c) {
+        pid_t pid = fork();
+        if (pid < 0) { perror("fork(client)"); r.ok = false; break; }
+        if (pid == 0) {
+            for (int i = 0; i < iters; ++i) {
+                // Co trzecie zajęcie obejmuje oba semafory, reszta k = 1 albo 2 jednego.
+                SemClaim cl[2];
+                size_t n = 1;
+                if ((c + i) % 3 == 2) {
+                    cl[0] = {0, 1};
+                    cl[1] = {1, 1};
+                    n = 2;
+                } else {
+                    cl[0] = {static_cast<unsigned short>(c % 2), static_cast<short>(1 + i % 2)};
+                }
+                const std::span<const SemClaim> claims(cl, n);
+                if (take(set, claims, sh) != 0) _exit(1);
+                hold(claims, caps, sh);
+                unhold(claims, sh);
+                if (set.release(claims) != 0) _exit(1);
+            }
+            _exit(0);
+        }
+        kids.push_back(pid);
+    }
+    for (pid_t k : kids) r.ok = join(k) && r.ok;
+    const int64_t t1 = now_ns();
+
+    r.wall_ms = static_cast<double>(t1 - t0) / 1e6;
+    r.claims_per_s = r.wall_ms > 0 ? static_cast<double>(clients) * iters * 1000.0 / r.wall_ms : 0.0;
+    r.busy = sh->busy.load();
+    r.timeouts = sh->timeouts.load();
+    r.violations = sh->violations.load();
+    // Każde zajęcie oddane: zbiór wraca do pojemności początkowej.
+    r.ok = r.ok && r.violations == 0 && set.value(0) == SEM_CAP && set.value(1) == SEM_CAP;
+
+    munmap(map, sizeof(SemShared));
+    set.remove();
+    return r;
+}
+
+/**
+ * @brief Two group processes with k = M on the park capacity set, @p iters claims each.
+ *
+ * Even claims take the tower and the ferry together in one semop; odd ones take
+ * one of them, claimant 0 the tower first and claimant 1 the ferry first.
+ * A claim is held across a yield, so the other group usually finds it full.
+ */
+static SemResult run_sem_groups(int iters, const char* token) {
+    SemResult r;
+    SysVSemaphoreSet set;
+    if (set.create_or_open(token, 'g', PARK_CAPS) < 0 || set.remove() < 0 ||
+        set.create_or_open(token, 'g', PARK_CAPS) < 0) {
+        r.ok = false;
+        return r;
+    }
+    void* map = mmap(nullptr, sizeof(SemShared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap(sem)");
+        set.remove();
+        r.ok = false;
+        return r;
+    }
+    SemShared* sh = new (map) SemShared();
+
+    constexpr unsigned short TOWER = 1, FERRY = 2;
+    const int64_t t0 = now_ns();
+    std::vector<pid_t> kids;
+    for (int c = 0; c < 2; ++c) {
+        pid_t pid = fork();
+        if (pid < 0) { perror("fork(group)"); r.ok = false; break; }
+        if (pid == 0) {
+            for (int i = 0; i < iters; ++i) {
+                SemClaim cl[2] = {{TOWER, PARK_M}, {FERRY, PARK_M}};
+                size_t n = 2;
+                if (i % 2 == 1) {
+                    cl[0] = {((i / 2 + c) % 2 == 0) ? TOWER : FERRY, PARK_M};
+                    n = 1;
+                }
+                const std::span<const SemClaim> claims(cl, n);
+                if (take(set, claims, sh) != 0) _exit(1);
+                hold(claims, PARK_CAPS, sh);
+                sched_yield();
+                unhold(claims, sh);
+                if (set.release(claims) != 0) _exit(1);
+            }
+            _exit(0);
+        }
+        kids.push_back(pid);
+    }
+    for (pid_t k : kids) r.ok = join(k) && r.ok;
+    const int64_t t1 = now_ns();
+
+    r.wall_ms = static_cast<double>(t1 - t0) / 1e6;
+    r.claims_per_s = r.wall_ms > 0 ? 2.0 * iters * 1000.0 / r.wall_ms : 0.0;
+    r.busy = sh->busy.load();
+    r.timeouts = sh->timeouts.load();
+    r.violations = sh->violations.load();
+    r.ok = r.ok && r.violations == 0;
+    for (int s = 0; s < 3; ++s) r.ok = r.ok && set.value(s) == PARK_CAPS[s];
+
+    munmap(map, sizeof(SemShared));
+    set.remove();
+    return r;
+}
+
+int main(int argc, char** argv) {
+    int clients = 4, iters = 20000;
+    std::string backend = "all";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--clients=", 10) == 0) clients = std::atoi(argv[i] + 10);
+        else if (std::strncmp(argv[i], "--iters=", 8) == 0) iters = std::atoi(argv[i] + 8);
+        else if (std::strncmp(argv[i], "--backend=", 10) == 0) backend = argv[i] + 10;
+        else {
+            std::fprintf(stderr, "usage: %s [--clients=N] [--iters=N] [--backend=all|both|msg|ring|sem]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (clients <= 0 || iters <= 0) {
+        std::fprintf(stderr, "ipc-bench: arguments must be positive\n");
+        return 2;
+    }
+    if (backend != "all" && backend != "both" && backend != "msg" && backend != "ring" && backend != "sem") {
+        std::fprintf(stderr, "ipc-bench: backend must be all, both (msg and ring), msg, ring or sem\n");
+        return 2;
+    }
+
+    const std::string token = "/tmp/ipc-bench." + std::to_string(getpid()) + ".key";
+    std::printf("clients=%d iters=%d\n", clients, iters);
+    bool ok = true;
+    for (const char* b : {"msg", "ring"}) {
+        if (backend != "all" && backend != "both" && backend != b) continue;
+        Result rt = run(b, true, clients, iters, token.c_str());
+        std::printf("%-5s rtt    wall=%.0fms msgs_per_s=%.0f rtt_avg=%.1fus p50=%.1fus p99=%.1fus max=%.0fus%s\n",
+                    b, rt.wall_ms, rt.msgs_per_s, rt.rtt_avg_us, rt.rtt_p50_us, rt.rtt_p99_us, rt.rtt_max_us,
+                    rt.ok ? "" : " FAILED");
+        Result ow = run(b, false, clients, iters, token.c_str());
+        std::printf("%-5s oneway wall=%.0fms msgs_per_s=%.0f%s\n",
+                    b, ow.wall_ms, ow.msgs_per_s, ow.ok ? "" : " FAILED");
+        ok = ok && rt.ok && ow.ok;
+    }
+    if (backend == "all" || backend == "sem") {
+        SemResult sr = run_sem(clients, iters, token.c_str());
+        std::printf("sem   claims wall=%.0fms claims_per_s=%.0f busy=%llu timeouts=%llu violations=%llu%s\n",
+                    sr.wall_ms, sr.claims_per_s, static_cast<unsigned long long>(sr.busy),
+                    static_cast<unsigned long long>(sr.timeouts), static_cast<unsigned long long>(sr.violations),
+                    sr.ok ? "" : " FAILED");
+        ok = ok && sr.ok;
+        SemResult gr = run_sem_groups(iters, token.c_str());
+        std::printf("sem   groups k=%d caps=%d/%d/%d wall=%.0fms claims_per_s=%.0f busy=%llu timeouts=%llu violations=%llu%s\n",
+                    PARK_M, PARK_CAPS[0], PARK_CAPS[1], PARK_CAPS[2], gr.wall_ms, gr.claims_per_s,
+                    static_cast<unsigned long long>(gr.busy), static_cast<unsigned long long>(gr.timeouts),
+                    static_cast<unsigned long long>(gr.violations), gr.ok ? "" : " FAILED");
+        ok = ok && gr.ok;
+    }
+    unlink(token.c_str());
+    return ok ? 0 : 1;
+}
@@ -68,7 +68,7 @@ int SysVMessageQueue::reset_queue(const char* token_path, int proj_id, int perms
  */
 int SysVMessageQueue::send_req(int tourist_id, int tourist_pid) {
     if (msqid_ < 0) { errno = EINVAL; perror("msgsnd(req): invalid msqid"); return -1; }
-    BridgeReqMsg msg{1, (int32_t)BridgeMsgKind::REQ_CROSS, tourist_id, tourist_pid};
+    BridgeReqMsg msg{1, (int32_t)BridgeMsgKind::REQ_CROSS, tourist_id, tourist_pid, 0, 0, 1, 0};
 
     if (msgsnd(msqid_, &msg, sizeof(BridgeReqMsg) - sizeof(long), 0) < 0) {
         perror("msgsnd(req)");
@@ -77,6 +77,22 @@ int SysVMessageQueue::send_req(int tourist_id, int tourist_pid) {
     return 0;
 }
 
+/**
+ * @brief Send a request built by the caller.
+ */
+int SysVMessageQueue::send_req(const BridgeReqMsg& msg) {
+    if (msqid_ < 0) { errno = EINVAL; perror("msgsnd(req): invalid msqid"); return -1; }
+    BridgeReqMsg m = msg;
+    m.mtype = 1;
+
+    while (msgsnd(msqid_, &m, sizeof(BridgeReqMsg) - sizeof(long), 0) < 0) {
+        if (errno == EINTR) continue;
+        perror("msgsnd(req)");
+        return -1;
+    }
+    return 0;
+}
+
 /**
  * @brief Receive next bridge crossing request.
  */
@@ -94,14 +110,32 @@ int SysVMessageQueue::recv_req(BridgeReqMsg* out) {
     return 0;
 }
 
+/**
+ * @brief Non-blocking receive of the next request.
+ */
+int SysVMessageQueue::try_recv_req(BridgeReqMsg* out) {
+    if (msqid_ < 0) { errno = EINVAL; perror("msgrcv(req): invalid msqid"); return -1; }
+    BridgeReqMsg msg{};
+
+    if (msgrcv(msqid_, &msg, sizeof(BridgeReqMsg) - sizeof(long), 1, IPC_NOWAIT) < 0) {
+        if (errno == ENOMSG) return 1;
+        if (errno != EINTR) perror("msgrcv(req)");
+        return -1;
+    }
+
+    if (out) *out = msg;
+    return 0;
+}
+
 /**
  * @brief Send completion notification to tourist pid.
  */
-int SysVMessageQueue::send_done(int tourist_id, int tourist_pid) {
+int SysVMessageQueue::send_done(int tourist_id, int tourist_pid, int64_t t_ns) {
     if (msqid_ < 0) { errno = EINVAL; perror("msgsnd(done): invalid msqid"); return -1; }
-    BridgeResMsg msg{(long)tourist_pid, (int32_t)BridgeMsgKind::RES_DONE, tourist_id};
+    BridgeResMsg msg{(long)tourist_pid, (int32_t)BridgeMsgKind::RES_DONE, tourist_id, t_ns};
 
-    if (msgsnd(msqid_, &msg, sizeof(BridgeResMsg) - sizeof(long), 0) < 0) {
+    while (msgsnd(msqid_, &msg, sizeof(BridgeResMsg) - sizeof(long), 0) < 0) {
+        if (errno == EINTR) continue;
         perror("msgsnd(done)");
         return -1;
     }
@@ -111,7 +145,7 @@ int SysVMessageQueue::send_done(int tourist_id, int tourist_pid) {
 /**
  * @brief Receive completion notification for this process.
  */
-int SysVMessageQueue::recv_done(int tourist_id, int tourist_pid) {
+int SysVMessageQueue::recv_done(int tourist_id, int tourist_pid, BridgeResMsg* out) {
     (void)tourist_id;
     if (msqid_ < 0) { errno = EINVAL; perror("msgrcv(done): invalid msqid"); return -1; }
     BridgeResMsg msg{};
@@ -120,5 +154,6 @@ int SysVMessageQueue::recv_done(int tourist_id, int tourist_pid) {
         if (errno != EINTR) perror("msgrcv(done)");
         return -1;
     }
+    if (out) *out = msg;
     return 0;
 }
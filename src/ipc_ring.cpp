@@ -0,0 +1,207 @@
+#include "ipc_ring.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <new>
+
+#include <sched.h>
+
+#include "futex.hpp"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<int32_t>::is_always_lock_free, "shared ring needs lock-free 32-bit atomics");
+
+/**
+ * @brief Fresh segment (a stale one from an interrupted run is dropped), cells numbered for the first lap.
+ */
+int ShmRingChannel::reset_queue(const char* token_path, int proj_id, int perms) {
+    if (shm_.create_or_open(token_path, proj_id, sizeof(RingShared), perms) < 0) return -1;
+    if (shm_.remove() < 0) return -1;
+    if (shm_.create_or_open(token_path, proj_id, sizeof(RingShared), perms) < 0) return -1;
+    void* a = shm_.attach();
+    if (!a) return -1;
+    r_ = new (a) RingShared();
+    for (uint32_t i = 0; i < RING_CELLS; ++i) r_->cells[i].seq.store(i, std::memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Detach and remove the segment.
+ */
+int ShmRingChannel::remove() {
+    r_ = nullptr;
+    if (shm_.detach() < 0) return -1;
+    return shm_.remove();
+}
+
+/**
+ * @brief Same scheme as MpmcQueue::try_push().
+ */
+bool ShmRingChannel::try_push(const BridgeReqMsg& msg) {
+    uint64_t pos = r_->tail.load(std::memory_order_relaxed);
+    RingShared::Cell* c;
+    while (true) {
+        c = &r_->cells[pos & (RING_CELLS - 1)];
+        uint64_t seq = c->seq.load(std::memory_order_acquire);
+        int64_t dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (dif == 0) {
+            if (r_->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            return false;
+        } else {
+            pos = r_->tail.load(std::memory_order_relaxed);
+        }
+    }
+    c->msg = msg;
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Single consumer: no CAS on head.
+ */
+bool ShmRingChannel::try_pop(BridgeReqMsg& out) {
+    uint64_t pos = r_->head.load(std::memory_order_relaxed);
+    RingShared::Cell& c = r_->cells[pos & (RING_CELLS - 1)];
+    if (c.seq.load(std::memory_order_acquire) != pos + 1) return false;
+    out = c.msg;
+    c.seq.store(pos + RING_CELLS, std::memory_order_release);
+    r_->head.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Shared (not FUTEX_PRIVATE) wait: the word lives in a segment mapped by many processes.
+ */
+void ShmRingChannel::wait(std::atomic<uint32_t>& word, uint32_t expected) {
+    r_->futex_waits.fetch_add(1, std::memory_order_relaxed);
+    futex_wait(word, expected);   // EAGAIN/EINTR: wołający i tak sprawdza stan ponownie
+}
+
+/**
+ * @brief Wake sleepers of @p word.
+ */
+void ShmRingChannel::wake(std::atomic<uint32_t>& word, int n) {
+    r_->futex_wakes.fetch_add(1, std::memory_order_relaxed);
+    if (futex_wake(word, n) < 0) perror("futex(wake)");
+}
+
+/**
+ * @brief Push, sleeping on `space` while full; then bump `items` and wake the server if it sleeps.
+ */
+int ShmRingChannel::send_req(const BridgeReqMsg& msg) {
+    if (!r_) { errno = EINVAL; perror("ring(req): not attached"); return -1; }
+    BridgeReqMsg m = msg;
+    m.mtype = 1;
+    while (true) {
+        uint32_t sp = r_->space.load();
+        if (try_push(m)) break;
+        r_->prod_waiting.fetch_add(1);
+        wait(r_->space, sp);
+        r_->prod_waiting.fetch_sub(1);
+    }
+    r_->items.fetch_add(1);   // seq_cst: para z cons_waiting w recv_req()
+    if (r_->cons_waiting.load() > 0) wake(r_->items, 1);
+    return 0;
+}
+
+/**
+ * @brief Pop, sleeping on `items` while empty; a freed cell wakes one waiting producer.
+ */
+int ShmRingChannel::recv_req(BridgeReqMsg* out) {
+    if (!r_) { errno = EINVAL; perror("ring(req): not attached"); return -1; }
+    BridgeReqMsg m{};
+    while (true) {
+        uint32_t it = r_->items.load();
+        if (try_pop(m)) break;
+        r_->cons_waiting.fetch_add(1);
+        wait(r_->items, it);
+        r_->cons_waiting.fetch_sub(1);
+    }
+    r_->space.fetch_add(1);
+    if (r_->prod_waiting.load() > 0) wake(r_->space, 1);
+    if (out) *out = m;
+    return 0;
+}
+
+/**
+ * @brief Pop without waiting.
+ */
+int ShmRingChannel::try_recv_req(BridgeReqMsg* out) {
+    if (!r_) { errno = EINVAL; perror("ring(req): not attached"); return -1; }
+    BridgeReqMsg m{};
+    if (!try_pop(m)) return 1;
+    r_->space.fetch_add(1);
+    if (r_->prod_waiting.load() > 0) wake(r_->space, 1);
+    if (out) *out = m;
+    return 0;
+}
+
+/**
+ * @brief Claim the first free mailbox in the probe window of the pid (only this process claims).
+ */
+int ShmRingChannel::send_done(int tourist_id, int tourist_pid, int64_t t_ns) {
+    if (!r_) { errno = EINVAL; perror("ring(done): not attached"); return -1; }
+    const uint32_t h = static_cast<uint32_t>(tourist_pid) % RING_BOXES;
+    RingShared::Mailbox* box = nullptr;
+    while (!box) {
+        for (uint32_t k = 0; k < RING_PROBE && !box; ++k) {
+            RingShared::Mailbox& b = r_->boxes[(h + k) % RING_BOXES];
+            if (b.owner.load(std::memory_order_acquire) == 0) box = &b;
+        }
+        if (!box) sched_yield();   // okno pełne: odbiorcy zaraz zwolnią skrzynki
+    }
+    box->owner.store(tourist_pid, std::memory_order_relaxed);
+    box->msg = BridgeResMsg{(long)tourist_pid, (int32_t)BridgeMsgKind::RES_DONE, tourist_id, t_ns};
+    box->full.store(1, std::memory_order_release);
+
+    RingShared::Home& home = r_->homes[h];
+    home.seq.fetch_add(1);   // seq_cst: para z waiters w recv_done()
+    if (home.waiters.load() > 0) wake(home.seq, INT_MAX);   // czekać mogą też inne pid o tym haszu
+    return 0;
+}
+
+/**
+ * @brief Scan the probe window for a full mailbox of this pid; sleep on its home word otherwise.
+ */
+int ShmRingChannel::recv_done(int tourist_id, int tourist_pid, BridgeResMsg* out) {
+    (void)tourist_id;
+    if (!r_) { errno = EINVAL; perror("ring(done): not attached"); return -1; }
+    const uint32_t h = static_cast<uint32_t>(tourist_pid) % RING_BOXES;
+    RingShared::Home& home = r_->homes[h];
+    while (true) {
+        uint32_t s = home.seq.load();
+        for (uint32_t k = 0; k < RING_PROBE; ++k) {
+            RingShared::Mailbox& b = r_->boxes[(h + k) % RING_BOXES];
+            if (b.owner.load(std::memory_order_acquire) != tourist_pid) continue;
+            if (b.full.load(std::memory_order_acquire) == 0) continue;
+            if (out) *out = b.msg;
+            b.full.store(0, std::memory_order_relaxed);
+            b.owner.store(0, std::memory_order_release);
+            return 0;
+        }
+        home.waiters.fetch_add(1);
+        wait(home.seq, s);
+        home.waiters.fetch_sub(1);
+    }
+}
+
+/**
+ * @brief Futex counters from the segment.
+ */
+ShmRingChannel::Counters ShmRingChannel::counters() const {
+    Counters c;
+    if (!r_) return c;
+    c.futex_waits = r_->futex_waits.load(std::memory_order_relaxed);
+    c.futex_wakes = r_->futex_wakes.load(std::memory_order_relaxed);
+    return c;
+}
+
+/**
+ * @brief Backend by name; "msg" is the default.
+ */
+std::unique_ptr<MsgChannel> make_msg_channel(const std::string& ipc) {
+    if (ipc == "ring") return std::make_unique<ShmRingChannel>();
+    return std::make_unique<SysVMessageQueue>();
+}
@@ -2,6 +2,8 @@
 
 #include <cerrno>
 #include <cstdio>
+#include <ctime>
+#include <vector>
 
 #include <sys/ipc.h>
 #include <sys/sem.h>
@@ -62,23 +64,37 @@ int SysVSemaphore::create_or_open(const char* token_path, int proj_id, int initi
 /**
  * @brief Decrement (P) the semaphore.
  */
-int SysVSemaphore::down() {
+int SysVSemaphore::down(bool undo) {
     if (semid_ < 0) { errno = EINVAL; perror("semop(down): invalid semid"); return -1; }
-    struct sembuf op{0, -1, (short)SEM_UNDO};
-    if (semop(semid_, &op, 1) < 0) { perror("semop(down)"); return -1; }
+    struct sembuf op{0, -1, (short)(undo ? SEM_UNDO : 0)};
+    while (semop(semid_, &op, 1) < 0) {
+        if (errno == EINTR) continue;
+        perror("semop(down)");
+        return -1;
+    }
     return 0;
 }
 
 /**
  * @brief Increment (V) the semaphore.
  */
-int SysVSemaphore::up() {
+int SysVSemaphore::up(bool undo) {
     if (semid_ < 0) { errno = EINVAL; perror("semop(up): invalid semid"); return -1; }
-    struct sembuf op{0, +1, (short)SEM_UNDO};
+    struct sembuf op{0, +1, (short)(undo ? SEM_UNDO : 0)};
     if (semop(semid_, &op, 1) < 0) { perror("semop(up)"); return -1; }
     return 0;
 }
 
+/**
+ * @brief Read the semaphore value.
+ */
+int SysVSemaphore::value() const {
+    if (semid_ < 0) { errno = EINVAL; return -1; }
+    int v = semctl(semid_, 0, GETVAL);
+    if (v < 0) perror("semctl(GETVAL)");
+    return v;
+}
+
 /**
  * @brief Remove the semaphore.
  */
@@ -88,3 +104,161 @@ int SysVSemaphore::remove() {
     semid_ = -1;
     return 0;
 }
+
+/**
+ * @brief Create or open a semaphore set; a new set gets the initial values with SETALL.
+ */
+int SysVSemaphoreSet::create_or_open(const char* token_path, int proj_id, std::span<const int> initial, int perms) {
+    if (initial.empty()) { errno = EINVAL; perror("semget(set): empty set"); return -1; }
+    if (ensure_token_file(token_path) < 0) return -1;
+
+    key_t key = ftok(token_path, proj_id);
+    if (key == (key_t)-1) { perror("ftok"); return -1; }
+
+    const int n = static_cast<int>(initial.size());
+    int semid = semget(key, n, IPC_CREAT | IPC_EXCL | perms);
+    if (semid >= 0) {
+        std::vector<unsigned short> vals(initial.begin(), initial.end());
+        union semun arg; arg.array = vals.data();
+        if (semctl(semid, 0, SETALL, arg) < 0) {
+            perror("semctl(SETALL)");
+            semctl(semid, 0, IPC_RMID);
+            return -1;
+        }
+        semid_ = semid;
+        nsems_ = n;
+        return 0;
+    }
+
+    if (errno != EEXIST) { perror("semget(create set)"); return -1; }
+
+    semid = semget(key, n, perms);
+    if (semid < 0) { perror("semget(open set)"); return -1; }
+    semid_ = semid;
+    nsems_ = n;
+    return 0;
+}
+
+/**
+ * @brief All claims go into one sembuf array, so the kernel applies them atomically.
+ */
+int SysVSemaphoreSet::op(std::span<const SemClaim> claims, int sign, bool undo, bool nowait, int timeout_ms) {
+    if (semid_ < 0) { errno = EINVAL; perror("semop(set): invalid semid"); return -1; }
+    std::vector<sembuf> ops;
+    ops.reserve(claims.size());
+    for (const SemClaim& c : claims) {
+        if (c.sem >= nsems_ || c.k <= 0) { errno = EINVAL; perror("semop(set): bad claim"); return -1; }
+        short flg = static_cast<short>((undo ? SEM_UNDO : 0) | (nowait ? IPC_NOWAIT : 0));
+        ops.push_back(sembuf{c.sem, static_cast<short>(sign * c.k), flg});
+    }
+
+    // Termin liczony raz: po EINTR czekamy tylko resztę czasu.
+    timespec deadline{};
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += static_cast<long>(timeout_ms % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) { ++deadline.tv_sec; deadline.tv_nsec -= 1000000000; }
+    }
+
+    while (true) {
+        int rc;
+        if (timeout_ms >= 0) {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            timespec left{deadline.tv_sec - now.tv_sec, deadline.tv_nsec - now.tv_nsec};
+            if (left.tv_nsec < 0) { --left.tv_sec; left.tv_nsec += 1000000000; }
+            if (left.tv_sec < 0) return 1;
+            rc = semtimedop(semid_, ops.data(), ops.size(), &left);
+        } else {
+            rc = semop(semid_, ops.data(), ops.size());
+        }
+        if (rc == 0) return 0;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN) return 1;
+        perror(sign < 0 ? "semop(acquire)" : "semop(release)");
+        return -1;
+    }
+}
+
+/**
+ * @brief Blocking all-or-nothing take.
+ */
+int SysVSemaphoreSet::acquire(std::span<const SemClaim> claims, bool undo) {
+    return op(claims, -1, undo, false, -1);
+}
+
+/**
+ * @brief Non-blocking all-or-nothing take.
+ */
+int SysVSemaphoreSet::try_acquire(std::span<const SemClaim> claims, bool undo) {
+    return op(claims, -1, undo, true, -1);
+}
+
+/**
+ * @brief All-or-nothing take with a timeout.
+ */
+int SysVSemaphoreSet::acquire_for(std::span<const SemClaim> claims, int timeout_ms, bool undo) {
+    if (timeout_ms < 0) { errno = EINVAL; perror("semtimedop: negative timeout"); return -1; }
+    return op(claims, -1, undo, false, timeout_ms);
+}
+
+/**
+ * @brief Give back all claims.
+ */
+int SysVSemaphoreSet::release(std::span<const SemClaim> claims, bool undo) {
+    return op(claims, +1, undo, false, -1);
+}
+
+/**
+ * @brief Single-semaphore acquire().
+ */
+int SysVSemaphoreSet::acquire(int sem, int k, bool undo) {
+    const SemClaim c{static_cast<unsigned short>(sem), static_cast<short>(k)};
+    return acquire(std::span<const SemClaim>(&c, 1), undo);
+}
+
+/**
+ * @brief Single-semaphore try_acquire().
+ */
+int SysVSemaphoreSet::try_acquire(int sem, int k, bool undo) {
+    const SemClaim c{static_cast<unsigned short>(sem), static_cast<short>(k)};
+    return try_acquire(std::span<const SemClaim>(&c, 1), undo);
+}
+
+/**
+ * @brief Single-semaphore acquire_for().
+ */
+int SysVSemaphoreSet::acquire_for(int sem, int k, int timeout_ms, bool undo) {
+    const SemClaim c{static_cast<unsigned short>(sem), static_cast<short>(k)};
+    return acquire_for(std::span<const SemClaim>(&c, 1), timeout_ms, undo);
+}
+
+/**
+ * @brief Single-semaphore release().
+ */
+int SysVSemaphoreSet::release(int sem, int k, bool undo) {
+    const SemClaim c{static_cast<unsigned short>(sem), static_cast<short>(k)};
+    return release(std::span<const SemClaim>(&c, 1), undo);
+}
+
+/**
+ * @brief Read the value of one semaphore of the set.
+ */
+int SysVSemaphoreSet::value(int sem) const {
+    if (semid_ < 0 || sem < 0 || sem >= nsems_) { errno = EINVAL; return -1; }
+    int v = semctl(semid_, sem, GETVAL);
+    if (v < 0) perror("semctl(GETVAL)");
+    return v;
+}
+
+/**
+ * @brief Remove the set.
+ */
+int SysVSemaphoreSet::remove() {
+    if (semid_ < 0) return 0;
+    if (semctl(semid_, 0, IPC_RMID) < 0) { perror("semctl(IPC_RMID)"); return -1; }
+    semid_ = -1;
+    nsems_ = 0;
+    return 0;
+}
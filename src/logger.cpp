@@ -1,16 +1,48 @@
 #include "logger.hpp"
+#include "sim_clock.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
 #include <filesystem>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+// Handler sygnału zdejmuje rekordy i czyta długości bufora - atomowe bez blokad.
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free &&
+              std::atomic<size_t>::is_always_lock_free, "signal drain needs lock-free atomics");
+
+static constexpr size_t kMaxRecord = 512;        // najdłuższa linia / rekord binarny z zapasem
+static constexpr size_t kOutBytes = 64 * 1024;   // bufor wyjściowy writera
+
 Logger* Logger::g_logger_ = nullptr;
 
+/**
+ * @brief Write the whole buffer, retrying on EINTR and short writes.
+ */
+static void write_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+}
+
 /**
  * @brief Construct logger writing to given path; truncates existing file.
  */
-Logger::Logger(const std::string& path)
+Logger::Logger(const std::string& path, const LogOptions& opt)
+    : opt_(opt)
 {
     namespace fs = std::filesystem;
 
@@ -22,31 +54,390 @@ Logger::Logger(const std::string& path)
         // jeśli create_directories się nie uda, i tak spróbujemy otworzyć plik, ale z lepszym błędem
     }
 
-    out_.open(path, std::ios::out | std::ios::trunc);
-    if (!out_.is_open()) {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
         std::ostringstream oss;
         oss << "Cannot open log file: " << path
             << " (cwd=" << fs::current_path().string() << ")";
         throw std::runtime_error(oss.str());
     }
 
-    t0_ = std::chrono::steady_clock::now();
+    if (opt_.binary) write_all(fd_, EV_MAGIC, sizeof(EV_MAGIC));
+
+    if (opt_.queue_cap == 0) opt_.queue_cap = 1;
+    if (opt_.flush_ms <= 0) opt_.flush_ms = 1;
+
+    if (opt_.async) {
+        uint64_t n = 2;
+        while (n < opt_.queue_cap) n <<= 1;
+        mask_ = n - 1;
+        ring_ = std::make_unique<Cell[]>(n);
+        for (uint64_t i = 0; i < n; ++i) ring_[i].seq.store(i, std::memory_order_relaxed);
+        out_ = std::make_unique<char[]>(kOutBytes);
+        writer_ = std::thread(&Logger::writer_loop, this);
+    }
 
     // ustaw globalny logger (jeśli korzystasz z Logger::log())
     g_logger_ = this;
 }
 
+/**
+ * @brief Stop the writer (draining everything queued) and close the file.
+ */
+Logger::~Logger()
+{
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(mu_);
+            stop_ = true;
+        }
+        writer_cv_.notify_all();
+        writer_.join();
+    }
+    if (g_logger_ == this) g_logger_ = nullptr;
+    if (fd_ >= 0) ::close(fd_);
+}
+
+namespace {
+
+/**
+ * @brief Bounded output cursor; excess bytes are dropped (cap is sized for the longest record).
+ */
+struct Out {
+    char* p;
+    size_t cap;
+    size_t n = 0;
+
+    void put(char c) {
+        if (n < cap) p[n++] = c;
+    }
+    void put(const char* s) {
+        while (*s) put(*s++);
+    }
+    void put(const char* s, size_t len) {
+        for (size_t i = 0; i < len; ++i) put(s[i]);
+    }
+    void put_int(int64_t v) {
+        char tmp[20];
+        uint64_t u = v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+        int k = 0;
+        do {
+            tmp[k++] = static_cast<char>('0' + u % 10);
+            u /= 10;
+        } while (u != 0);
+        if (v < 0) put('-');
+        while (k > 0) put(tmp[--k]);
+    }
+    // LEB128 i zigzag - format czytany przez EvReader.
+    void put_varint(uint64_t v) {
+        while (v >= 0x80) {
+            put(static_cast<char>((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        put(static_cast<char>(v));
+    }
+    void put_svarint(int64_t v) {
+        put_varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+};
+
+/**
+ * @brief Tag and message of a TEXT record, packed as "tag\0msg\0" in the args bytes.
+ */
+void text_parts(const EventRecord& ev, const char*& tag, const char*& msg) {
+    tag = reinterpret_cast<const char*>(ev.args);
+    msg = tag + std::strlen(tag) + 1;
+}
+
+} // namespace
+
 /**
  * @brief Log a message with relative timestamp in milliseconds.
+ *
+ * The text is packed into the fixed record (tag + message up to 78 bytes in all);
+ * longer messages are cut.
  */
 void Logger::log_ts(const std::string& tag, const std::string& msg)
 {
-    auto now = std::chrono::steady_clock::now();
-    auto ms  = std::chrono::duration_cast<std::chrono::milliseconds>(now - t0_).count();
+    LogRec r{};
+    r.t_ms = SimClock::global().now_ms();
+    r.ev.type = Ev::TEXT;
+    char* b = reinterpret_cast<char*>(r.ev.args);
+    const size_t room = sizeof(r.ev.args) - 2;   // dwa terminatory
+    const size_t nt = std::min(tag.size(), room);
+    const size_t nm = std::min(msg.size(), room - nt);
+    std::memcpy(b, tag.data(), nt);
+    b[nt] = '\0';
+    std::memcpy(b + nt + 1, msg.data(), nm);
+    b[nt + 1 + nm] = '\0';
+    emit(r);
+}
+
+/**
+ * @brief Copy the event into a record; formatting happens in render().
+ */
+void Logger::on_event(int64_t t_ms, const EventRecord& r)
+{
+    if (r.type == Ev::TEXT || r.nargs != ev_schema(r.type).nargs) {
+        log_ts("LOG", "BAD_EVENT type=" + std::to_string(static_cast<int>(r.type)));
+        return;
+    }
+    emit(LogRec{t_ms, r});
+}
+
+/**
+ * @brief Sync: one write() per record under mu_ (file order = delta order). Async: ring push,
+ *        sleeping only while the ring is full.
+ */
+void Logger::emit(const LogRec& r)
+{
+    if (!opt_.async) {
+        char buf[kMaxRecord];
+        std::lock_guard<std::mutex> lk(mu_);
+        write_all(fd_, buf, render(buf, sizeof(buf), r));
+        return;
+    }
+
+    if (!try_push(r)) {
+        std::unique_lock<std::mutex> lk(mu_);
+        space_waiters_.fetch_add(1);
+        writer_cv_.notify_one();
+        // Writer zwalnia miejsce i budzi nas pod mu_, więc sprawdzenie pod mu_ niczego nie gubi.
+        space_cv_.wait(lk, [&]{ return try_push(r) || stop_; });
+        space_waiters_.fetch_sub(1);
+        return;
+    }
+    // Pół pierścienia zajęte, a writer śpi: budzimy go wcześniej niż po flush_ms.
+    if (backlog() >= opt_.queue_cap / 2 && writer_idle_.load()) {
+        std::lock_guard<std::mutex> lk(mu_);
+        writer_cv_.notify_one();
+    }
+}
+
+/**
+ * @brief Text: "t=<ms>ms TAG body\n" with the template expanded as ev_format() does.
+ *        Binary: svarint time delta, type byte, fields (or the two TEXT strings).
+ */
+size_t Logger::render(char* out, size_t cap, const LogRec& r)
+{
+    Out o{out, cap};
+    const EventRecord& ev = r.ev;
+
+    if (opt_.binary) {
+        o.put_svarint(r.t_ms - last_ms_.exchange(r.t_ms, std::memory_order_relaxed));
+        o.put(static_cast<char>(ev.type));
+        if (ev.type == Ev::TEXT) {
+            const char* tag;
+            const char* msg;
+            text_parts(ev, tag, msg);
+            o.put_varint(std::strlen(tag));
+            o.put(tag);
+            o.put_varint(std::strlen(msg));
+            o.put(msg);
+        } else {
+            for (int i = 0; i < ev.nargs; ++i) o.put_svarint(ev.args[i]);
+        }
+        return o.n;
+    }
 
-    std::lock_guard<std::mutex> lk(mu_);
-    out_ << "t=" << ms << "ms " << tag << " " << msg << "\n";
-    out_.flush();
+    o.put("t=");
+    o.put_int(r.t_ms);
+    o.put("ms ");
+    if (ev.type == Ev::TEXT) {
+        const char* tag;
+        const char* msg;
+        text_parts(ev, tag, msg);
+        o.put(tag);
+        o.put(' ');
+        o.put(msg);
+    } else {
+        const EvSchema& sc = ev_schema(ev.type);
+        o.put(sc.tag);
+        o.put(' ');
+        int ai = 0;
+        for (const char* f = sc.fmt; *f; ++f) {
+            if (*f != '%' || f[1] == '\0') {
+                o.put(*f);
+                continue;
+            }
+            ++f;
+            switch (*f) {
+                case 'i': o.put_int(ev.args[ai++]); break;
+                case 'd': o.put(dir_str(static_cast<Direction>(ev.args[ai++]))); break;
+                case 'c': o.put(static_cast<char>(ev.args[ai++])); break;
+                default:  o.put('%'); o.put(*f); break;
+            }
+        }
+    }
+    o.put('\n');
+    return o.n;
+}
+
+/**
+ * @brief Same scheme as MpmcQueue::try_push(), the record copied into the cell.
+ */
+bool Logger::try_push(const LogRec& r)
+{
+    uint64_t pos = tail_.load(std::memory_order_relaxed);
+    Cell* c;
+    while (true) {
+        c = &ring_[pos & mask_];
+        const uint64_t seq = c->seq.load(std::memory_order_acquire);
+        const int64_t dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (dif == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            return false;
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+    c->rec = r;
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief CAS on head: the writer is the usual consumer, the signal handler may take the rest.
+ */
+bool Logger::try_pop(LogRec& r)
+{
+    uint64_t pos = head_.load(std::memory_order_relaxed);
+    Cell* c;
+    while (true) {
+        c = &ring_[pos & mask_];
+        const uint64_t seq = c->seq.load(std::memory_order_acquire);
+        const int64_t dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+        if (dif == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            return false;
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+    r = c->rec;
+    c->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief tail - head (approximate while producers run).
+ */
+uint64_t Logger::backlog() const
+{
+    const uint64_t h = head_.load(std::memory_order_relaxed);
+    const uint64_t t = tail_.load(std::memory_order_relaxed);
+    return t > h ? t - h : 0;
+}
+
+/**
+ * @brief Block until every record queued so far is written.
+ */
+void Logger::flush()
+{
+    if (!opt_.async) return;
+    std::unique_lock<std::mutex> lk(mu_);
+    flush_to_ = std::max(flush_to_, tail_.load());
+    writer_cv_.notify_one();
+    space_cv_.wait(lk, [&]{ return written_ >= flush_to_ || stop_; });
+}
+
+/**
+ * @brief Writer thread: wakes every flush_ms (or when the ring fills up), renders and writes.
+ */
+void Logger::writer_loop()
+{
+    std::unique_lock<std::mutex> lk(mu_);
+    while (true) {
+        writer_idle_.store(true);
+        writer_cv_.wait_for(lk, std::chrono::milliseconds(opt_.flush_ms), [&]{
+            return stop_ || written_ < flush_to_ || space_waiters_.load() > 0 ||
+                   backlog() >= opt_.queue_cap / 2;
+        });
+        writer_idle_.store(false);
+        const bool stopping = stop_;
+        lk.unlock();
+
+        LogRec r;
+        while (try_pop(r)) {
+            size_t len = out_len_.load(std::memory_order_relaxed);
+            if (len + kMaxRecord > kOutBytes) {
+                write_out();
+                len = 0;
+            }
+            out_len_.store(len + render(out_.get() + len, kMaxRecord, r), std::memory_order_release);
+        }
+        write_out();
+
+        lk.lock();
+        written_ = head_.load();
+        space_cv_.notify_all();
+        if (stopping && head_.load() == tail_.load()) break;
+    }
+}
+
+/**
+ * @brief One contiguous buffer: write() until done, out_done_ tracks progress for the signal handler.
+ */
+void Logger::write_out()
+{
+    const size_t n = out_len_.load(std::memory_order_relaxed);
+    const char* p = out_.get();
+    size_t d = out_done_.load(std::memory_order_relaxed);
+    while (d < n) {
+        ssize_t w = ::write(fd_, p + d, n - d);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        d += static_cast<size_t>(w);
+        out_done_.store(d, std::memory_order_release);
+    }
+    // len przed done: handler nie wypisze drugi raz zapisanych już bajtów.
+    out_len_.store(0, std::memory_order_release);
+    out_done_.store(0, std::memory_order_release);
+}
+
+/**
+ * @brief Best-effort drain from a signal handler: the unwritten rest of out_,
+ *        then every published record still in the ring - no locks, no allocation.
+ */
+void Logger::drain_on_signal()
+{
+    if (!opt_.async) return;
+    const size_t d = out_done_.load(std::memory_order_acquire);
+    const size_t n = out_len_.load(std::memory_order_acquire);
+    if (d < n) write_all(fd_, out_.get() + d, n - d);
+
+    char buf[kMaxRecord];
+    LogRec r;
+    while (try_pop(r)) write_all(fd_, buf, render(buf, sizeof(buf), r));
+}
+
+/**
+ * @brief Drain the global logger, then re-raise with the default action.
+ */
+void Logger::on_fatal_signal(int sig)
+{
+    if (g_logger_) g_logger_->drain_on_signal();
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
+
+/**
+ * @brief Install drain handlers for SIGINT/SIGTERM and crash signals.
+ */
+void Logger::install_signal_drain()
+{
+    const int sigs[] = {SIGINT, SIGTERM, SIGHUP, SIGSEGV, SIGBUS, SIGFPE, SIGABRT};
+    for (int s : sigs) {
+        struct sigaction sa{};
+        sa.sa_handler = &Logger::on_fatal_signal;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESETHAND;
+        sigaction(s, &sa, nullptr);
+    }
 }
 
 /**
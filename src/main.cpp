@@ -6,16 +6,20 @@
 #include <iostream>
 #include <netinet/in.h>
 #include <memory>
-#include <random>
 #include <string>
 #include <sys/socket.h>
 #include <thread>
 #include <unistd.h>
-#include <vector>
 
+#include "arrivals.hpp"
 #include "config.hpp"
+#include "coro.hpp"
+#include "event_bus.hpp"
+#include "event_sinks.hpp"
 #include "logger.hpp"
 #include "park.hpp"
+#include "proc_park.hpp"
+#include "sim_clock.hpp"
 #include "tourist.hpp"
 
 static int run_status_server(int port, std::atomic<int>& entered, std::atomic<int>& exited) {
@@ -62,6 +66,127 @@ static int run_status_server(int port, std::atomic<int>& entered, std::atomic<in
     return 0;
 }
 
+/**
+ * @brief --mode=process: fork a tourist process per arrival, wait for all, print counters and IPC cost.
+ */
+static int run_process_mode(const Config& cfg, ArrivalProcess& arrivals, EventBus& bus,
+                            const std::string& log_path) {
+    SimClock& clk = SimClock::global();
+    auto t0 = std::chrono::steady_clock::now();
+
+    ProcessPark pp(cfg, bus);
+    if (!pp.ok()) return 1;
+
+    ArrivalProcess::Arrival a;
+    int arrived = 0;
+    int64_t last_arrival_ms = 0;
+    bool spawn_failed = false;
+    while (arrivals.next(a)) {
+        int64_t wait = a.at_ms - clk.now_ms();
+        if (wait > 0) clk.sleep_ms(static_cast<int>(wait));
+        pp.reap();
+        if (!pp.spawn(arrived, a.age, a.vip)) {
+            spawn_failed = true;
+            break;
+        }
+        ++arrived;
+        last_arrival_ms = a.at_ms;
+    }
+    pp.wait_all();
+    pp.stop_servers();
+    const int64_t sim_ms = clk.now_ms();
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    clk.stop();
+
+    ProcessPark::Stats ps = pp.stats();
+    std::cout << "[SUMMARY] tourists=" << arrived
+              << " admitted=" << ps.entered
+              << " exited=" << ps.exited
+              << " log=" << log_path
+              << " mode=process"
+              << "\n";
+    std::cout << "[ARRIVALS] mode=" << cfg.arrivals
+              << " arrived=" << arrived
+              << " last_arrival_ms=" << last_arrival_ms
+              << " peak_live=" << ps.peak_live;
+    if (cfg.arrivals == "trace") std::cout << " speed=" << cfg.replay_speed << " skipped=" << arrivals.skipped();
+    std::cout << "\n";
+    // Koszt izolacji: fork() w rodzicu i semop w turystach (niekontestowany koszt z kalibracji).
+    // Tylko workload=solo (bez przewodników, grup i opiekunów): porównywać z
+    // --mode=inproc --workload=solo, nie z domyślnym guided. Przy --attractions=sem
+    // prom nie ma kursów (każdy płynie, gdy się zmieści) - to jedyna różnica.
+    int64_t overhead_us = ps.fork_us_sum + static_cast<int64_t>(ps.semops) * ps.semop_ns / 1000;
+    std::cout << "[PROCESS] workload=" << cfg.workload
+              << " baseline=inproc_solo"
+              << " unmodeled=" << (ps.servers ? "none" : "ferry_departures")
+              << " forks=" << ps.forks
+              << " fork_retries=" << ps.fork_retries
+              << " fork_us_avg=" << (ps.forks ? ps.fork_us_sum / ps.forks : 0)
+              << " fork_us_max=" << ps.fork_us_max
+              << " child_failures=" << ps.child_failures
+              << " rejected=" << ps.rejected
+              << " bridge=" << ps.bridge_crossings
+              << " tower=" << ps.tower_visits
+              << " ferry=" << ps.ferry_rides
+              << " semops=" << ps.semops
+              << " cap_waits=" << ps.cap_waits
+              << " semop_ns=" << ps.semop_ns
+              << " ipc_overhead_ms=" << overhead_us / 1000
+              << " wall_s=" << wall_s
+              << "\n";
+    // Arena stanu dzielonego: zajętość, rekordy turystów i szczyty obecności
+    // wg listy obecnych (prom w trybie server niewidoczny).
+    std::cout << "[ARENA] bytes_used=" << ps.arena_used
+              << " bytes=" << ps.arena_size
+              << " recs_peak=" << ps.recs_peak
+              << " recs_capacity=" << ps.recs_capacity
+              << " peak_in_park=" << ps.peak_in_park
+              << " peak_bridge=" << ps.peak_at[static_cast<int>(Spot::BRIDGE)]
+              << " peak_tower=" << ps.peak_at[static_cast<int>(Spot::TOWER)]
+              << " peak_ferry=" << ps.peak_at[static_cast<int>(Spot::FERRY)]
+              << " lock_contended=" << ps.roster_contended
+              << "\n";
+    // Serwery atrakcji: opóźnienie żądania (do zdjęcia z kolejki) i odpowiedzi,
+    // pełny obieg z czekaniem na miejsce, paczki na jedno obudzenie i przepustowość.
+    if (ps.servers) {
+        static const char* const names[3] = {"bridge", "tower", "ferry"};
+        for (int i = 0; i < 3; ++i) {
+            const ServerStats& sv = ps.srv[i];
+            int64_t reqs = static_cast<int64_t>(sv.reqs);
+            int64_t replies = static_cast<int64_t>(sv.replies);
+            double per_s = (sv.busy_ns > 0) ? static_cast<double>(sv.reqs) * 1e9 /
+                                              static_cast<double>(sv.busy_ns) : 0.0;
+            std::cout << "[SERVER] name=" << names[i]
+                      << " ipc=" << cfg.ipc
+                      << " reqs=" << sv.reqs
+                      << " wakeups=" << sv.wakeups
+                      << " batch_avg=" << (sv.wakeups ? static_cast<double>(sv.reqs) / sv.wakeups : 0.0)
+                      << " batch_max=" << sv.max_batch
+                      << " req_lat_us_avg=" << (reqs ? sv.req_lat_ns_sum / reqs / 1000 : 0)
+                      << " req_lat_us_max=" << sv.req_lat_ns_max / 1000
+                      << " res_lat_us_avg=" << (replies ? sv.res_lat_ns_sum / replies / 1000 : 0)
+                      << " res_lat_us_max=" << sv.res_lat_ns_max / 1000
+                      << " rtt_us_avg=" << (replies ? sv.rtt_ns_sum / replies / 1000 : 0)
+                      << " busy_ms=" << sv.busy_ns / 1000000
+                      << " reqs_per_busy_s=" << static_cast<long long>(per_s);
+            if (cfg.ipc == "ring") {
+                std::cout << " futex_waits=" << ps.ring[i].futex_waits
+                          << " futex_wakes=" << ps.ring[i].futex_wakes;
+            }
+            std::cout << "\n";
+        }
+    }
+    double per_h = (sim_ms > 0) ? static_cast<double>(ps.exited) * 3600000.0 /
+                                  static_cast<double>(sim_ms) : 0.0;
+    std::cout << "[ROUTES] policy=random"
+              << " route1=" << ps.route_picks[0]
+              << " route2=" << ps.route_picks[1]
+              << " sim_ms=" << sim_ms
+              << " throughput_per_h=" << static_cast<long long>(per_h + 0.5)
+              << "\n";
+    return spawn_failed || ps.child_failures ? 1 : 0;
+}
+
 int main(int argc, char** argv) {
     Config cfg;
     try {
@@ -72,8 +197,49 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    Logger log("logs/park.log");
-    Park park(cfg, log);
+    ArrivalProcess arrivals(cfg);
+    if (!arrivals.ok()) return 1;
+
+    SimClock& clk = SimClock::global();
+    clk.set_mode(cfg.clock_mode == "virtual" ? ClockMode::VIRTUAL : ClockMode::REAL);
+    clk.start();
+
+    LogOptions log_opt;
+    log_opt.async = (cfg.log_mode == "async");
+    log_opt.flush_ms = cfg.log_flush_ms;
+    log_opt.queue_cap = static_cast<size_t>(cfg.log_queue);
+    log_opt.binary = (cfg.log_format == "binary");
+    const std::string log_path = (cfg.log_format == "none") ? "none"
+                               : log_opt.binary ? "logs/park.bin" : "logs/park.log";
+
+    // Subskrybenci szyny zdarzeń: log, statystyki, trace.
+    EventBus bus;
+    std::unique_ptr<Logger> log;
+    if (cfg.log_format != "none") {
+        log = std::make_unique<Logger>(log_path, log_opt);
+        Logger::install_signal_drain();
+        bus.subscribe(log.get());
+    }
+    EventStats stats;
+    if (cfg.stats) bus.subscribe(&stats);
+    std::unique_ptr<EventTracer> tracer;
+    if (!cfg.trace_path.empty()) {
+        tracer = std::make_unique<EventTracer>(cfg.trace_path);
+        bus.subscribe(tracer.get());
+    }
+
+    // --mode=process: turyści jako procesy potomne, bez Parku w tym procesie.
+    if (cfg.mode == "process") return run_process_mode(cfg, arrivals, bus, log_path);
+
+    Park park(cfg, bus);
+
+    // --exec=coro: kasjer, przewodnicy i turyści jako korutyny na puli z kradzieżą pracy
+    // zamiast wątku na aktora.
+    std::unique_ptr<Scheduler> sched;
+    if (cfg.exec == "coro") {
+        sched = std::make_unique<Scheduler>(cfg.workers, clk);
+        park.sched = sched.get();
+    }
 
     std::atomic<int> entered{0};
     std::atomic<int> exited{0};
@@ -82,40 +248,142 @@ int main(int argc, char** argv) {
         std::thread(run_status_server, cfg.status_port, std::ref(entered), std::ref(exited)).detach();
     }
 
+    // Wątek main jest aktorem zegara tylko na czas wpuszczania turystów.
+    clk.actor_spawned();
     park.start();
 
-    std::mt19937 rng(cfg.seed);
-    std::uniform_int_distribution<int> age_dist(3, 70);
-    std::bernoulli_distribution vip_dist(cfg.vip_prob);
-
-    std::vector<std::unique_ptr<Tourist>> tourists;
-    tourists.reserve(static_cast<size_t>(cfg.tourists_total));
-
-    for (int i = 0; i < cfg.tourists_total; ++i) {
-        int age = age_dist(rng);
-        bool vip = vip_dist(rng);
-        auto t = std::make_unique<Tourist>(i, age, vip, &park);
-        t->start();
-        tourists.push_back(std::move(t));
+    // Turyści powstają w chwili przyjścia i są zwalniani po wyjściu z parku.
+    Visitors visitors;
+    ArrivalProcess::Arrival a;
+    int64_t last_arrival_ms = 0;
+    while (arrivals.next(a)) {
+        int64_t wait = a.at_ms - clk.now_ms();
+        if (wait > 0) clk.sleep_ms(static_cast<int>(wait));
+        visitors.reap();
+        visitors.start(std::make_unique<Tourist>(visitors.started(), a.age, a.vip, &park));
+        last_arrival_ms = a.at_ms;
     }
+    const int arrived = visitors.started();
 
     // Wait until all tourists have enqueued at the cashier, then close entry.
-    while (park.enqueued.load() < cfg.tourists_total) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    while (park.enqueued.load() < arrived) {
+        clk.sleep_ms(10);
     }
     park.close();
+    clk.actor_finished();
 
-    for (auto& t : tourists) t->join();
+    if (sched) sched->wait_all();
+    visitors.wait_all();
 
     park.stop();
+    if (sched) sched->stop();
+    const int64_t sim_ms = clk.now_ms();
+    clk.stop();
 
     entered.store(park.entered.load());
     exited.store(park.exited.load());
 
-    std::cout << "[SUMMARY] tourists=" << cfg.tourists_total
+    std::cout << "[SUMMARY] tourists=" << arrived
               << " admitted=" << park.entered.load()
               << " exited=" << park.exited.load()
-              << " log=logs/park.log\n";
+              << " log=" << log_path
+              << " workload=" << cfg.workload;
+    if (sched) {
+        Scheduler::Stats st = sched->stats();
+        double per_s = (st.wall_s > 0.0) ? static_cast<double>(st.tasks) / st.wall_s : 0.0;
+        std::cout << " workers=" << st.workers
+                  << " tasks=" << st.tasks
+                  << " tasks_per_s=" << static_cast<long long>(per_s)
+                  << " steals=" << st.steals
+                  << " idle_ms=" << st.idle_ms;
+    }
+    std::cout << "\n";
+
+    // Przyjścia: ile osób i ile naraz w parku (obiekty Tourist żyją tylko w tym czasie).
+    std::cout << "[ARRIVALS] mode=" << cfg.arrivals
+              << " arrived=" << arrived
+              << " last_arrival_ms=" << last_arrival_ms
+              << " peak_live=" << visitors.peak_live();
+    if (cfg.arrivals == "trace") std::cout << " speed=" << cfg.replay_speed << " skipped=" << arrivals.skipped();
+    std::cout << "\n";
+
+    // Wejście: odmowy przy pełnej kolejce, rezygnacje po czasie, czekanie na wpuszczenie.
+    Park::EntryStats ens = park.entry_stats();
+    std::cout << "[ENTRY] cap=" << cfg.entry_cap
+              << " patience_ms=" << cfg.patience_ms
+              << " admitted=" << ens.admitted
+              << " rejected=" << ens.rejected
+              << " balked=" << ens.balked
+              << " reneged=" << ens.reneged
+              << " wait_p50_ms=" << ens.wait_p50_ms
+              << " wait_p90_ms=" << ens.wait_p90_ms
+              << " wait_p99_ms=" << ens.wait_p99_ms
+              << " wait_max_ms=" << ens.wait_max_ms
+              << "\n";
+    // Prom: wykorzystanie miejsc po wszystkich kursach i czekanie na zabranie per kierunek.
+    Ferry::Stats fs = park.ferry.stats();
+    double util = fs.trips ? 100.0 * static_cast<double>(fs.seats) /
+                             (static_cast<double>(fs.trips) * cfg.X3) : 0.0;
+    auto wait_avg = [&](int b) {
+        return fs.boarded[b] ? fs.wait_ms[b] / static_cast<int64_t>(fs.boarded[b]) : 0;
+    };
+    std::cout << "[FERRY] trips=" << fs.trips
+              << " empty_trips=" << fs.empty_trips
+              << " util=" << static_cast<int>(util + 0.5) << "%"
+              << " fwd_boarded=" << fs.boarded[0]
+              << " fwd_wait_avg_ms=" << wait_avg(0)
+              << " fwd_wait_max_ms=" << fs.wait_max_ms[0]
+              << " bwd_boarded=" << fs.boarded[1]
+              << " bwd_wait_avg_ms=" << wait_avg(1)
+              << " bwd_wait_max_ms=" << fs.wait_max_ms[1]
+              << "\n";
+    // Grupy: ile pełnych / niepełnych, rozkład czasu w kolejce i zajętość przewodników
+    // (czas z grupą / czas na służbie, sumowane po przewodnikach).
+    Park::GroupStats gs = park.group_stats();
+    int formed = gs.full + gs.timeout + gs.final;
+    double guide_util = (gs.guide_duty_ms > 0) ? 100.0 * static_cast<double>(gs.guide_busy_ms) /
+                                                 static_cast<double>(gs.guide_duty_ms) : 0.0;
+    std::cout << "[GROUPS] formed=" << formed
+              << " full=" << gs.full
+              << " timeout=" << gs.timeout
+              << " final=" << gs.final
+              << " avg_size=" << (formed ? static_cast<double>(gs.members) / formed : 0.0)
+              << " wait_p50_ms=" << gs.wait_p50_ms
+              << " wait_p90_ms=" << gs.wait_p90_ms
+              << " wait_p99_ms=" << gs.wait_p99_ms
+              << " wait_max_ms=" << gs.wait_max_ms
+              << " guide_util=" << static_cast<int>(guide_util + 0.5) << "%"
+              << " policy=" << cfg.group_policy
+              << " tour_avg_ms=" << (formed ? gs.guide_busy_ms / formed : 0)
+              << " slow_groups=" << gs.slow_groups
+              << " guard_none=" << gs.guard_none
+              << " deny=" << park.group_denies.load();
+    if (cfg.elastic_guides()) {
+        std::cout << " guides=" << cfg.guides_core() << ".." << cfg.P_max
+                  << " guides_peak=" << gs.guides_peak
+                  << " scale_ups=" << gs.scale_ups
+                  << " scale_downs=" << gs.scale_downs
+                  << " guide_duty_ms=" << gs.guide_duty_ms;
+    }
+    std::cout << "\n";
+    // Biurko wyjść: opóźnienie od report_exit() do zalogowania CASHIER EXIT.
+    Park::ExitStats es = park.exit_stats();
+    std::cout << "[EXITS] logged=" << es.logged
+              << " batches=" << es.batches
+              << " lat_avg_us=" << (es.logged ? es.lat_sum_us / es.logged : 0)
+              << " lat_max_us=" << es.lat_max_us
+              << " lat_max_sim_ms=" << es.lat_max_sim_ms
+              << "\n";
+    // Trasy: ile grup i VIP-ów wybrało każdą oraz przepustowość parku w czasie symulacji.
+    double per_h = (sim_ms > 0) ? static_cast<double>(park.exited.load()) * 3600000.0 /
+                                  static_cast<double>(sim_ms) : 0.0;
+    std::cout << "[ROUTES] policy=" << cfg.route_policy
+              << " route1=" << park.route_picks[0].load()
+              << " route2=" << park.route_picks[1].load()
+              << " sim_ms=" << sim_ms
+              << " throughput_per_h=" << static_cast<long long>(per_h + 0.5)
+              << "\n";
+    if (cfg.stats) stats.print_summary(std::cout);
 
     return 0;
 }
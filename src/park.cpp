@@ -5,31 +5,16 @@
 #include <algorithm>
 #include <chrono>
 #include <memory>
-#include <sstream>
 #include <thread>
 
 /**
- * @brief Construct park with resources initialized from config and logger.
+ * @brief Construct park with resources initialized from config and event bus.
  */
-Park::Park(const Config& cfg_, Logger& log_)
-    : cfg(cfg_), log(log_), bridge(cfg.X1, log_), tower(cfg.X2, log_), ferry(cfg.X3, log_), rng(cfg.seed) {}
-
-/**
- * @brief Thread-safe uniform integer.
- */
-int Park::rand_int(int lo, int hi) {
-    std::lock_guard<std::mutex> lk(rng_mu);
-    std::uniform_int_distribution<int> dist(lo, hi);
-    return dist(rng);
-}
-
-/**
- * @brief Thread-safe uniform double in [0,1).
- */
-double Park::rand01() {
-    std::lock_guard<std::mutex> lk(rng_mu);
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-    return dist(rng);
+Park::Park(const Config& cfg_, EventBus& bus_)
+    : cfg(cfg_), bus(bus_), clock(SimClock::global()),
+      bridge(cfg.X1, bus_), tower(cfg.X2, bus_), ferry(cfg.X3, cfg.ferry_T_ms, bus_),
+      group_q(static_cast<size_t>(cfg.N)) {   // do grup trafiają tylko wpuszczeni (<= N)
+    for (int i = 0; i < cfg.cashiers; ++i) entry.push_back(std::make_unique<EntryShard>());
 }
 
 /**
@@ -42,13 +27,13 @@ static Direction dir_from_route(int route, Direction d_for_route1, Direction d_f
 /**
  * @brief Sleep in slices while checking abort flag.
  */
-static void sleep_interruptible_ms(int total_ms, std::atomic<bool>& abort_flag) {
+static CoTask sleep_interruptible_ms(int total_ms, std::atomic<bool>& abort_flag) {
     int slice = 50;
     int slept = 0;
     while (slept < total_ms) {
-        if (abort_flag.load()) return;
+        if (abort_flag.load()) co_return;
         int d = std::min(slice, total_ms - slept);
-        std::this_thread::sleep_for(std::chrono::milliseconds(d));
+        co_await co_sleep(d);
         slept += d;
     }
 }
@@ -56,13 +41,10 @@ static void sleep_interruptible_ms(int total_ms, std::atomic<bool>& abort_flag)
 /**
  * @brief Execute one simulation step for a guided tourist, handling group coordination and constraints.
  */
-void Park::do_step(Tourist* t, Step s, int epoch) {
-    auto deny_no_guard_for = [&](Tourist* who, const char* where) {
-        log.log_ts("GUARD",
-                   std::string("DENY_NO_GUARD id=") + std::to_string(who->id) +
-                   " age=" + std::to_string(who->age) +
-                   " where=" + where +
-                   " gid=" + std::to_string(who->group_id));
+CoTask Park::do_step(Tourist* t, Step s, int epoch) {
+    auto deny_no_guard_for = [&](Tourist* who, char where) {
+        bus.emit(GuardDenyNoGuard{who->id, who->age, where, who->group_id});
+        group_denies.fetch_add(1);
     };
 
     int route = (t->group ? t->group->route : 1);
@@ -75,15 +57,16 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
             // Bridge nadal "symbolicznie" (1 osoba), ale grupa logicznie razem.
             auto g = t->group;
             if (!g) {
-                bridge.enter(t->id, bridge_dir);
-                int ms = rand_int(cfg.bridge_min_ms, cfg.bridge_max_ms);
-                std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+                co_await bridge.enter(t->id, bridge_dir);
+                int ms = t->rng.uniform_int(cfg.bridge_min_ms, cfg.bridge_max_ms);
+                bridge_svc_ms.add(ms);
+                co_await co_sleep(ms);
                 bridge.leave(t->id);
                 break;
             }
 
             if (!g->bridge_try_become_coordinator(epoch, t->id)) {
-                g->bridge_wait_done(epoch);
+                co_await g->bridge_wait_done(epoch);
                 break;
             }
 
@@ -92,14 +75,15 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
                 if (!m) continue;
                 if (m->age < 15) {
                     if (m->no_guard.load() || m->guardian == nullptr) {
-                        deny_no_guard_for(m, "A");
+                        deny_no_guard_for(m, 'A');
                     }
                 }
             }
 
-            bridge.enter(t->id, bridge_dir);
-            int ms = rand_int(cfg.bridge_min_ms, cfg.bridge_max_ms);
-            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            co_await bridge.enter(t->id, bridge_dir);
+            int ms = t->rng.uniform_int(cfg.bridge_min_ms, cfg.bridge_max_ms);
+            bridge_svc_ms.add(ms);
+            co_await co_sleep(ms);
             bridge.leave(t->id);
 
             g->bridge_finish(epoch);
@@ -110,22 +94,23 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
             auto g = t->group;
             if (!g) {
                 if (t->age <= 5) {
-                    log.log_ts("TOWER", "DENY id=" + std::to_string(t->id) + " reason=AGE<=5");
+                    bus.emit(TowerDenyAge5{t->id});
                     break;
                 }
                 if (t->guardian_of_u5.load()) {
-                    log.log_ts("TOWER", "DENY id=" + std::to_string(t->id) + " reason=GUARD_OF_AGE<=5");
+                    bus.emit(TowerDenyGuardOfU5{t->id});
                     break;
                 }
-                tower.enter(t->id, t->vip);
-                int ms = rand_int(cfg.tower_min_ms, cfg.tower_max_ms);
-                sleep_interruptible_ms(ms, t->tower_evacuate);
+                co_await tower.enter(t->id, t->vip);
+                int ms = t->rng.uniform_int(cfg.tower_min_ms, cfg.tower_max_ms);
+                tower_svc_ms.add(ms);
+                co_await sleep_interruptible_ms(ms, t->tower_evacuate);
                 tower.leave(t->id);
                 break;
             }
 
             if (!g->tower_try_become_coordinator(epoch, t->id)) {
-                g->tower_wait_done(epoch);
+                co_await g->tower_wait_done(epoch);
                 break;
             }
 
@@ -135,22 +120,25 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
                 if (!m) continue;
 
                 if (m->age <= 5) {
-                    log.log_ts("TOWER", "DENY id=" + std::to_string(m->id) + " reason=AGE<=5");
+                    bus.emit(TowerDenyAge5{m->id});
+                    group_denies.fetch_add(1);
                     continue;
                 }
                 if (m->guardian_of_u5.load()) {
-                    log.log_ts("TOWER", "DENY id=" + std::to_string(m->id) + " reason=GUARD_OF_AGE<=5");
+                    bus.emit(TowerDenyGuardOfU5{m->id});
+                    group_denies.fetch_add(1);
                     continue;
                 }
 
                 if (m->age < 15) {
                     if (m->no_guard.load() || m->guardian == nullptr) {
-                        deny_no_guard_for(m, "B");
+                        deny_no_guard_for(m, 'B');
                         continue;
                     }
                     // Jeśli opiekun nie może wejść na wieżę, dziecko też odpada
                     if (m->guardian->guardian_of_u5.load()) {
-                        log.log_ts("TOWER", "DENY id=" + std::to_string(m->id) + " reason=GUARD_CANNOT_TOWER");
+                        bus.emit(TowerDenyGuardCannot{m->id});
+                        group_denies.fetch_add(1);
                         continue;
                     }
                 }
@@ -159,22 +147,21 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
             }
 
             if (k <= 0) {
-                log.log_ts("TOWER", "GROUP_SKIP gid=" + std::to_string(t->group_id) + " reason=NO_ELIGIBLE");
+                bus.emit(TowerGroupSkip{t->group_id});
                 g->tower_finish(epoch);
                 break;
             }
 
             // Guided grupa jest non-VIP => vip_like = false
-            tower.enter_group(t->group_id, k, false);
+            co_await tower.enter_group(t->group_id, k, false);
 
-            int ms = rand_int(cfg.tower_min_ms, cfg.tower_max_ms);
+            int ms = t->rng.uniform_int(cfg.tower_min_ms, cfg.tower_max_ms);
+            tower_svc_ms.add(ms);
             if (t->tower_evacuate.load()) {
-                log.log_ts("TOWER",
-                           "EVACUATE_GROUP gid=" + std::to_string(t->group_id) +
-                           " k=" + std::to_string(k));
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                bus.emit(TowerEvacuateGroup{t->group_id, k});
+                co_await co_sleep(100);
             } else {
-                sleep_interruptible_ms(ms, t->tower_evacuate);
+                co_await sleep_interruptible_ms(ms, t->tower_evacuate);
             }
 
             tower.leave_group(t->group_id, k);
@@ -187,18 +174,16 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
             if (!g) {
                 if (t->age < 15) {
                     if (t->no_guard.load() || t->guardian == nullptr) {
-                        deny_no_guard_for(t, "C");
+                        deny_no_guard_for(t, 'C');
                         break;
                     }
                 }
-                ferry.board(t->id, t->vip, ferry_dir);
-                std::this_thread::sleep_for(std::chrono::milliseconds(cfg.ferry_T_ms));
-                ferry.unboard(t->id);
+                co_await ferry.ride(t->id, t->vip, ferry_dir);
                 break;
             }
 
             if (!g->ferry_try_become_coordinator(epoch, t->id)) {
-                g->ferry_wait_done(epoch);
+                co_await g->ferry_wait_done(epoch);
                 break;
             }
 
@@ -207,7 +192,7 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
                 if (!m) continue;
                 if (m->age < 15) {
                     if (m->no_guard.load() || m->guardian == nullptr) {
-                        deny_no_guard_for(m, "C");
+                        deny_no_guard_for(m, 'C');
                         continue;
                     }
                 }
@@ -215,24 +200,20 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
             }
 
             if (k <= 0) {
-                log.log_ts("FERRY", "GROUP_SKIP gid=" + std::to_string(t->group_id) + " reason=NO_ELIGIBLE");
+                bus.emit(FerryGroupSkip{t->group_id});
                 g->ferry_finish(epoch);
                 break;
             }
 
-            ferry.board_group(t->group_id, k, false, ferry_dir);
-            std::this_thread::sleep_for(std::chrono::milliseconds(cfg.ferry_T_ms));
-            ferry.unboard_group(t->group_id, k);
+            co_await ferry.ride_group(t->group_id, k, false, ferry_dir);
 
             g->ferry_finish(epoch);
             break;
         }
 
         case Step::RETURN_K: {
-            log.log_ts("TOURIST",
-                       "RETURN_K id=" + std::to_string(t->id) +
-                       " gid=" + std::to_string(t->group_id));
-            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            bus.emit(TouristReturnK{t->id, t->group_id});
+            co_await co_sleep(200);
             break;
         }
 
@@ -242,13 +223,121 @@ void Park::do_step(Tourist* t, Step s, int epoch) {
 }
 
 /**
- * @brief Start cashier and guide threads.
+ * @brief Start cashier, guides and the ferry as threads, or as scheduler tasks in coro mode.
  */
 void Park::start() {
-    cashier_thr = std::thread(&Park::cashier_loop, this);
-    for (int i = 0; i < cfg.P; ++i) {
-        guide_thrs.emplace_back(&Park::guide_loop, this, i);
+    cashiers_live.store(cfg.cashiers);
+    if (sched) {
+        for (int c = 0; c < cfg.cashiers; ++c) sched->spawn(cashier_loop(c));
+        sched->spawn_daemon(ferry.run());   // kończy się w stop(), po turystach
+        sched->spawn_daemon(exit_desk_loop());
+    } else {
+        clock.actor_spawned();
+        ferry_thr = std::thread([this] {
+            SimClock::ActorGuard actor(clock);
+            ferry.run().run_inline();
+        });
+        clock.actor_spawned();
+        exit_thr = std::thread([this] {
+            SimClock::ActorGuard actor(clock);
+            exit_desk_loop().run_inline();
+        });
+        for (int c = 0; c < cfg.cashiers; ++c) {
+            clock.actor_spawned();
+            cashier_thrs.emplace_back([this, c] {
+                SimClock::ActorGuard actor(clock);
+                cashier_loop(c).run_inline();
+            });
+        }
+    }
+
+    if (!cfg.guided()) return;   // solo: nikt nie czeka na grupę
+    for (int i = 0; i < cfg.guides_core(); ++i) add_guide(false);
+
+    if (!cfg.elastic_guides()) return;
+    if (sched) {
+        sched->spawn_daemon(guide_supervisor());
+    } else {
+        clock.actor_spawned();
+        sup_thr = std::thread([this] {
+            SimClock::ActorGuard actor(clock);
+            guide_supervisor().run_inline();
+        });
+    }
+}
+
+/**
+ * @brief Start a guide on the scheduler or on its own thread.
+ */
+int Park::add_guide(bool elastic) {
+    std::lock_guard<std::mutex> lk(guides_mu);
+    int id = next_guide_id++;
+    int active = guides_active.fetch_add(1) + 1;
+    {
+        std::lock_guard<std::mutex> slk(group_stats_mu);
+        group_st.guides_peak = std::max(group_st.guides_peak, active);
     }
+
+    if (sched) {
+        sched->spawn(guide_loop(id, elastic));
+    } else {
+        clock.actor_spawned();
+        guide_thrs.emplace_back([this, id, elastic] {
+            SimClock::ActorGuard actor(clock);
+            guide_loop(id, elastic).run_inline();
+        });
+    }
+    return id;
+}
+
+/**
+ * @brief On-call dispatcher: add a guide when the backlog is deep or old and nobody is idle;
+ *        ask an extra guide to leave after guide_idle_ms with idle guides and no full group.
+ */
+CoTask Park::guide_supervisor() {
+    const int up_depth = (cfg.guide_up_depth > 0) ? cfg.guide_up_depth : 2 * cfg.M;
+    const int core = cfg.guides_core();
+    int64_t idle_since = -1;
+
+    while (!sup_stop.load()) {
+        co_await co_sleep(GUIDE_TICK_MS);
+
+        int64_t now = clock.now_ms();
+        int depth = group_avail();
+        int active = guides_active.load();
+        int64_t since = (depth > 0) ? group_oldest_since() : -1;
+        int64_t oldest_wait = (since >= 0) ? now - since : 0;
+        bool someone_idle = group_sleepers.load() > 0;
+
+        if (!someone_idle && active < cfg.P_max && depth > 0 &&
+            (depth >= up_depth || oldest_wait >= cfg.guide_up_wait_ms)) {
+            int id = add_guide(true);
+            {
+                std::lock_guard<std::mutex> lk(group_stats_mu);
+                ++group_st.scale_ups;
+            }
+            bus.emit(GuideScaleUp{id, active + 1, depth, static_cast<int>(oldest_wait)});
+            idle_since = -1;
+            continue;
+        }
+
+        if (someone_idle && active > core && depth < cfg.M && guides_retire.load() == 0) {
+            if (idle_since < 0) {
+                idle_since = now;
+            } else if (now - idle_since >= cfg.guide_idle_ms) {
+                guides_retire.fetch_add(1);
+                std::lock_guard<std::mutex> lk(group_mu);
+                group_cv.notify_all();
+                idle_since = -1;
+            }
+        } else {
+            idle_since = -1;
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(guides_mu);
+    sup_done = true;
+    sup_done_cv.notify_all();
 }
 
 /**
@@ -257,165 +346,675 @@ void Park::start() {
 void Park::stop() {
     close();
 
-    if (cashier_thr.joinable()) cashier_thr.join();
+    if (cfg.guided() && cfg.elastic_guides()) {
+        sup_stop.store(true);
+        if (sup_thr.joinable()) {
+            sup_thr.join();
+        } else if (sched) {
+            std::unique_lock<std::mutex> lk(guides_mu);
+            sup_done_cv.wait(lk, [&]{ return sup_done; });
+        }
+    }
+
+    for (auto& t : cashier_thrs) if (t.joinable()) t.join();
     for (auto& t : guide_thrs) if (t.joinable()) t.join();
+
+    ferry.shutdown();
+    if (ferry_thr.joinable()) ferry_thr.join();
+    else if (sched) ferry.wait_stopped();
+
+    // Turyści już skończyli, więc wszystkie wyjścia są zgłoszone; biurko loguje resztę i kończy.
+    {
+        std::lock_guard<std::mutex> lk(exit_mu);
+        exit_stop = true;
+        exit_cv.notify_all();
+    }
+    if (exit_thr.joinable()) {
+        exit_thr.join();
+    } else if (sched) {
+        std::unique_lock<std::mutex> lk(exit_mu);
+        exit_done_cv.wait(lk, [&]{ return exit_done; });
+    }
 }
 
 void Park::close() {
     open.store(false);
-    entry_cv.notify_all();
-    group_cv.notify_all();
-    exit_cv.notify_all();
+    for (auto& sh : entry) {
+        std::lock_guard<std::mutex> lk(sh->mu);
+        sh->cv.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lk(group_mu);
+        group_cv.notify_all();
+    }
 }
 
 /**
- * @brief Enqueue tourist for cashier entry with VIP priority.
+ * @brief Enqueue tourist in its cashier shard with VIP priority.
  */
-void Park::enqueue_entry(Tourist* t) {
+bool Park::enqueue_entry(Tourist* t) {
+    EntryShard& sh = *entry[static_cast<size_t>(t->id) % entry.size()];
+
+    // Miejsce w kolejce rezerwujemy CAS-em, żeby wspólny limit działał bez globalnej blokady.
+    int q = entry_queued.load();
+    do {
+        if (cfg.entry_cap > 0 && q >= cfg.entry_cap) {
+            bus.emit(TouristBalk{t->id, q, cfg.entry_cap});
+            {
+                std::lock_guard<std::mutex> lk(entry_stats_mu);
+                ++entry_st.balked;
+            }
+            enqueued.fetch_add(1);
+            return false;
+        }
+    } while (!entry_queued.compare_exchange_weak(q, q + 1));
+
+    int64_t since;
+    EntryShard* peer = nullptr;
     {
-        std::lock_guard<std::mutex> lk(entry_mu);
-        if (t->vip) entry_vip.push_back(t);
-        else entry_norm.push_back(t);
+        std::lock_guard<std::mutex> lk(sh.mu);
+        since = clock.now_ms();
+        t->entry_since_ms = since;
+        if (t->vip) {
+            sh.vip.push_back(t);
+            entry_vips.fetch_add(1);
+        } else {
+            sh.norm.push_back(t);
+        }
+        sh.cv.notify_all();
+        // Pod sh.mu: kasjer ustawia idle przed przejrzeniem cudzych shardów (pod
+        // ich mutexami), więc albo zobaczy ten wpis, albo my zobaczymy jego idle.
+        const size_t K = entry.size();
+        const size_t self = static_cast<size_t>(t->id) % K;
+        for (size_t k = 1; k < K && !peer; ++k) {
+            EntryShard* p = entry[(self + k) % K].get();
+            if (p->idle.load()) peer = p;
+        }
+    }
+    if (peer) {
+        // Poza sh.mu (kolejność blokad shardów nieustalona); zdjęte idle to znak dla kasjera.
+        std::lock_guard<std::mutex> lk(peer->mu);
+        if (peer->idle.exchange(false)) peer->cv.notify_all();
     }
     enqueued.fetch_add(1);
-    entry_cv.notify_one();
+    if (cfg.patience_ms > 0) arm_renege_timer(since + cfg.patience_ms);
+    return true;
 }
 
 /**
- * @brief Dequeue next tourist for cashier; blocks until available or park closed.
+ * @brief Arm the single renege timer unless one fires earlier (same scheme as the group timer).
  */
-Tourist* Park::dequeue_for_cashier() {
-    std::unique_lock<std::mutex> lk(entry_mu);
-    entry_cv.wait(lk, [&]{
-        return !open.load() || !entry_vip.empty() || !entry_norm.empty();
+void Park::arm_renege_timer(int64_t due) {
+    {
+        std::lock_guard<std::mutex> lk(renege_mu);
+        if (renege_due != 0 && renege_due <= due) return;
+        if (renege_due != 0 && clock.cancel(renege_timer)) renege_timer = 0;
+        renege_due = due;
+    }
+    // Poza renege_mu: przy ms <= 0 callback wykona się od razu.
+    int64_t ms = due - clock.now_ms();
+    SimClock::TimerId id = clock.call_after(static_cast<int>(std::max<int64_t>(ms, 0)), [this, due] {
+        {
+            std::lock_guard<std::mutex> lk(renege_mu);
+            if (renege_due == due) {
+                renege_due = 0;
+                renege_timer = 0;
+            }
+        }
+        sweep_reneges();
+        clock.release();   // jednostka przekazana przez call_after
     });
+    std::lock_guard<std::mutex> lk(renege_mu);
+    if (renege_due == due) renege_timer = id;
+}
+
+/**
+ * @brief Cancel the pending renege timer; a queue drained by the cashiers needs none.
+ */
+void Park::cancel_renege_timer() {
+    std::lock_guard<std::mutex> lk(renege_mu);
+    if (renege_due != 0 && clock.cancel(renege_timer)) {
+        renege_due = 0;
+        renege_timer = 0;
+    }
+}
+
+/**
+ * @brief Pop expired waiters from the front of every shard queue (queues are in arrival order).
+ */
+void Park::sweep_reneges() {
+    const int64_t now = clock.now_ms();
+    std::vector<Tourist*> gone;
+    int64_t next = 0;
+    for (auto& shp : entry) {
+        EntryShard& sh = *shp;
+        std::lock_guard<std::mutex> lk(sh.mu);
+        for (auto* q : {&sh.vip, &sh.norm}) {
+            while (!q->empty() && now - q->front()->entry_since_ms >= cfg.patience_ms) {
+                gone.push_back(q->front());
+                q->pop_front();
+                if (q == &sh.vip) entry_vips.fetch_sub(1);
+            }
+            if (!q->empty()) {
+                int64_t due = q->front()->entry_since_ms + cfg.patience_ms;
+                if (next == 0 || due < next) next = due;
+            }
+        }
+    }
+    entry_queued.fetch_sub(static_cast<int>(gone.size()));
 
-    if (!entry_vip.empty()) {
-        auto* t = entry_vip.front();
-        entry_vip.pop_front();
-        return t;
+    if (!gone.empty()) {
+        std::lock_guard<std::mutex> lk(entry_stats_mu);
+        entry_st.reneged += static_cast<int>(gone.size());
+    }
+    for (Tourist* t : gone) {
+        bus.emit(TouristRenege{t->id, static_cast<int>(now - t->entry_since_ms)});
+        t->on_reneged();
     }
-    if (!entry_norm.empty()) {
-        auto* t = entry_norm.front();
-        entry_norm.pop_front();
-        return t;
+    if (next > 0) arm_renege_timer(next);
+}
+
+/**
+ * @brief Move up to @p max tourists from the front of @p q.
+ */
+int Park::take_locked(std::deque<Tourist*>& q, int max, std::vector<Tourist*>& out) {
+    int n = 0;
+    while (n < max && !q.empty()) {
+        out.push_back(q.front());
+        q.pop_front();
+        ++n;
+    }
+    entry_queued.fetch_sub(n);
+    return n;
+}
+
+/**
+ * @brief Batch for cashier @p c: own VIPs, other shards' VIPs, own regulars, then steal regulars.
+ */
+CoTask Park::dequeue_for_cashier(int c, std::vector<Tourist*>& out) {
+    out.clear();
+    const int K = static_cast<int>(entry.size());
+    EntryShard& own = *entry[c];
+    auto room = [&] { return ENTRY_BATCH - static_cast<int>(out.size()); };
+
+    // Kolejki opróżnione - timer rezygnacji niepotrzebny (nie przetrzymuje zegara do końca).
+    auto note_drained = [&] {
+        if (cfg.patience_ms > 0 && entry_queued.load() == 0) cancel_renege_timer();
+    };
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lk(own.mu);
+            entry_vips.fetch_sub(take_locked(own.vip, room(), out));
+        }
+        for (int k = 1; k < K && room() > 0 && entry_vips.load() > 0; ++k) {
+            EntryShard& sh = *entry[(c + k) % K];
+            std::lock_guard<std::mutex> lk(sh.mu);
+            entry_vips.fetch_sub(take_locked(sh.vip, room(), out));
+        }
+        {
+            std::lock_guard<std::mutex> lk(own.mu);
+            take_locked(own.norm, room(), out);
+        }
+        if (!out.empty()) {
+            note_drained();
+            co_return;
+        }
+
+        // Własny shard pusty: zgłaszamy bezczynność (enqueue_entry w cudzym shardzie
+        // nas obudzi) i podbieramy zwykłych od pozostałych kasjerów.
+        own.idle.store(true);
+        for (int k = 1; k < K && room() > 0; ++k) {
+            EntryShard& sh = *entry[(c + k) % K];
+            std::lock_guard<std::mutex> lk(sh.mu);
+            take_locked(sh.norm, room(), out);
+        }
+        if (!out.empty()) {
+            own.idle.store(false);
+            note_drained();
+            co_return;
+        }
+
+        std::unique_lock<std::mutex> lk(own.mu);
+        if (!own.vip.empty() || !own.norm.empty() || !own.idle.load()) {   // idle zdjęte = ktoś nas wołał
+            own.idle.store(false);
+            continue;
+        }
+        if (!open.load()) {
+            own.idle.store(false);
+            co_return;
+        }
+        co_await own.cv.wait(lk);
+        own.idle.store(false);
+    }
+}
+
+/**
+ * @brief Take a daily ticket with a CAS loop, so concurrent cashiers never exceed N.
+ */
+int Park::try_admit() {
+    int cur = entered.load();
+    while (cur < cfg.N) {
+        if (entered.compare_exchange_weak(cur, cur + 1)) return cur + 1;
     }
-    return nullptr;
+    return 0;
 }
 
 /**
- * @brief Enqueue tourist waiting to form a guided group.
+ * @brief Push tourist to the group queue; wake sleeping guides once a group can be taken.
  */
 void Park::enqueue_group_wait(Tourist* t) {
-    {
+    t->group_since_ms.store(clock.now_ms());
+    while (!group_q.try_push(t)) std::this_thread::yield();   // pojemność >= N, nie powinno się zdarzyć
+    bool last = group_pending.fetch_sub(1) == 1;
+
+    // Para z dequeue_group: tam group_sleepers++ przed sprawdzeniem ready().
+    // Budzimy na pełną grupę, po ostatnim wpuszczonym (resztka na koniec dnia)
+    // albo (timeout) gdy trzeba uzbroić timer najstarszego.
+    int r = group_avail();
+    bool wake = r >= cfg.M || (last && groups_closed()) ||
+                (cfg.group_timeout_ms > 0 && r >= cfg.group_min && group_timer_due.load() == 0);
+    if (wake && group_sleepers.load() > 0) {
         std::lock_guard<std::mutex> lk(group_mu);
-        group_wait.push_back(t);
+        group_cv.notify_all();
     }
-    group_cv.notify_one();
 }
 
 /**
- * @brief Dequeue exactly M tourists to form a group; blocks until enough.
+ * @brief Pop claimed members and record how long each waited.
  */
-std::vector<Tourist*> Park::dequeue_group(int M) {
-    std::unique_lock<std::mutex> lk(group_mu);
-    group_cv.wait(lk, [&]{
-        return !open.load() || static_cast<int>(group_wait.size()) >= M;
-    });
+void Park::take_group(int n, std::vector<Tourist*>& out, int& kind) {
+    for (int i = 0; i < n; ++i) out.push_back(group_q.pop_claimed());
+    note_group(out, kind);
+}
 
-    std::vector<Tourist*> g;
-    if (static_cast<int>(group_wait.size()) < M) {
-        if (!open.load()) {
+/**
+ * @brief Count the group and store each member's time in the queue.
+ */
+void Park::note_group(const std::vector<Tourist*>& out, int& kind) {
+    int64_t now = clock.now_ms();
+    std::lock_guard<std::mutex> lk(group_stats_mu);
+    ++kind;
+    group_st.members += static_cast<int>(out.size());
+    for (auto* t : out) group_waits_ms.push_back(static_cast<int>(now - t->group_since_ms.load()));
+}
+
+/**
+ * @brief Pick @p n members of @p pool (indices, ascending): the oldest always goes,
+ *        then members with the same pace (all < 12 or all >= 12), then guardians for children.
+ *
+ * Adults are swapped in for the newest picked children until every child has a guardian,
+ * and a second adult is added when u5 children (their guardian skips the tower) come with
+ * older ones.
+ */
+static std::vector<size_t> compose_pick(const std::deque<Tourist*>& pool, size_t n) {
+    std::vector<size_t> pick{0};
+    std::vector<bool> used(pool.size(), false);
+    used[0] = true;
+    const bool slow = pool[0]->age < 12;
+
+    for (int pass = 0; pass < 2 && pick.size() < n; ++pass) {
+        for (size_t i = 1; i < pool.size() && pick.size() < n; ++i) {
+            if (used[i]) continue;
+            bool same_pace = (pool[i]->age < 12) == slow;
+            if (pass == 0 && !same_pace) continue;
+            pick.push_back(i);
+            used[i] = true;
+        }
+    }
+
+    while (true) {
+        int adults = 0;
+        bool u5 = false, older_child = false;
+        for (size_t i : pick) {
+            int age = pool[i]->age;
+            if (age >= 15) ++adults;
+            else if (age <= 5) u5 = true;
+            else older_child = true;
+        }
+        int need = (u5 && older_child) ? 2 : (u5 || older_child) ? 1 : 0;
+        if (adults >= need) break;
+
+        size_t adult = 0;
+        for (size_t i = 1; i < pool.size() && adult == 0; ++i) {
+            if (!used[i] && pool[i]->age >= 15) adult = i;
+        }
+        size_t child = 0;   // najpóźniej dobrane dziecko (nie najstarszy w oknie)
+        for (size_t k = pick.size(); k-- > 1 && child == 0;) {
+            if (pool[pick[k]]->age < 15) child = k;
+        }
+        if (adult == 0 || child == 0) break;   // w oknie nie ma kogo zamienić
+        used[pick[child]] = false;
+        pick[child] = adult;
+        used[adult] = true;
+    }
+
+    std::sort(pick.begin(), pick.end());
+    return pick;
+}
+
+/**
+ * @brief Refill the window to group_window_size() in arrival order, then take a composed group.
+ */
+bool Park::compose_group(int lo, int hi, std::vector<Tourist*>& out, int& kind) {
+    std::lock_guard<std::mutex> lk(group_pool_mu);
+    int want = cfg.group_window_size() - static_cast<int>(group_pool.size());
+    if (want > 0) {
+        // Najpierw doliczamy do okna, potem zdejmujemy z ready(): group_avail() nigdy nie zaniża.
+        group_pool_n.fetch_add(want);
+        int n = group_q.try_claim_upto(1, want);
+        for (int i = 0; i < n; ++i) group_pool.push_back(group_q.pop_claimed());
+        group_pool_n.fetch_sub(want - n);
+    }
+    if (static_cast<int>(group_pool.size()) < lo) return false;
+
+    size_t n = std::min(group_pool.size(), static_cast<size_t>(hi));
+    std::vector<size_t> pick = compose_pick(group_pool, n);
+    for (size_t i : pick) out.push_back(group_pool[i]);
+    for (size_t k = pick.size(); k-- > 0;) group_pool.erase(group_pool.begin() + static_cast<long>(pick[k]));
+    group_pool_n.fetch_sub(static_cast<int>(pick.size()));
+    note_group(out, kind);
+    return true;
+}
+
+/**
+ * @brief Oldest waiter: the compose window holds the earliest arrivals, then the ring.
+ */
+int64_t Park::group_oldest_since() {
+    if (group_pool_n.load() > 0) {
+        std::lock_guard<std::mutex> lk(group_pool_mu);
+        if (!group_pool.empty()) return group_pool.front()->group_since_ms.load();
+    }
+    Tourist* oldest = nullptr;
+    return group_q.peek(oldest) ? oldest->group_since_ms.load() : -1;
+}
+
+/**
+ * @brief Claim M tourists; with --group-timeout-ms leave with >= group_min once the oldest waited long enough.
+ */
+CoTask Park::dequeue_group(int M, std::vector<Tourist*>& out, bool may_retire) {
+    out.clear();
+    const int timeout = cfg.group_timeout_ms;
+
+    const bool compose = (cfg.group_policy == "compose");
+
+    // Termin najstarszego czekającego (0 = brak niepełnej grupy do wypuszczenia po timeout).
+    auto oldest_due = [&]() -> int64_t {
+        if (timeout <= 0 || group_avail() < cfg.group_min) return 0;
+        int64_t since = group_oldest_since();
+        return (since < 0) ? 0 : since + timeout;
+    };
+    // Grupa lo..hi osób: FIFO z pierścienia albo dobór składu w oknie (compose).
+    auto claim = [&](int lo, int hi, int& kind) {
+        if (compose) return compose_group(lo, hi, out, kind);
+        int n = (lo == hi) ? (group_q.try_claim(lo) ? lo : 0) : group_q.try_claim_upto(lo, hi);
+        if (n > 0) take_group(n, out, kind);
+        return n > 0;
+    };
+    auto take_retire = [&] {
+        int r = guides_retire.load();
+        while (r > 0) {
+            if (guides_retire.compare_exchange_weak(r, r - 1)) return true;
+        }
+        return false;
+    };
+
+    while (true) {
+        if (group_avail() >= M && claim(M, M, group_st.full)) co_return;
+
+        int64_t due = oldest_due();
+        const bool closed = groups_closed();
+        if (due > 0 && (due <= clock.now_ms() || closed)) {
+            if (claim(cfg.group_min, M, closed ? group_st.final : group_st.timeout)) co_return;
+            continue;
+        }
+        if (may_retire && take_retire()) co_return;   // dodatkowy przewodnik odchodzi
+        if (closed && due == 0) {
             // final partial group when park closed
-            while (!group_wait.empty()) {
-                g.push_back(group_wait.front());
-                group_wait.pop_front();
+            claim(1, M, group_st.final);
+            co_return;
+        }
+
+        std::unique_lock<std::mutex> lk(group_mu);
+        group_sleepers.fetch_add(1);
+        due = oldest_due();
+        const int64_t now = clock.now_ms();   // jeden odczyt: termin i opóźnienie timera z tej samej chwili
+        bool ready_now = group_avail() >= M || groups_closed() || (due > 0 && due <= now) ||
+                         (may_retire && guides_retire.load() > 0);
+        if (!ready_now) {
+            // Jeden timer na termin najstarszego: budzi przewodników, gdy niepełna grupa może ruszyć.
+            int64_t armed = group_timer_due.load();
+            if (due > 0 && (armed == 0 || armed > due)) {
+                group_timer_due.store(due);
+                // >= 1 ms: call_after(0) wykonałby callback od razu, a ten bierze group_mu (trzymany tu).
+                clock.call_after(static_cast<int>(std::max<int64_t>(due - now, 1)), [this, due] {
+                    {
+                        std::lock_guard<std::mutex> tlk(group_mu);
+                        if (group_timer_due.load() == due) group_timer_due.store(0);
+                        group_cv.notify_all();
+                    }
+                    clock.release();   // jednostka przekazana przez call_after
+                });
             }
+            co_await group_cv.wait(lk);
         }
-        return g;
+        group_sleepers.fetch_sub(1);
     }
+}
 
-    for (int i = 0; i < M; ++i) {
-        g.push_back(group_wait.front());
-        group_wait.pop_front();
+/**
+ * @brief Nearest-rank p50/p90/p99 and max of @p waits (copied and sorted).
+ */
+static void wait_percentiles(std::vector<int> w, int& p50, int& p90, int& p99, int& max) {
+    std::sort(w.begin(), w.end());
+    auto pct = [&](int p) {
+        if (w.empty()) return 0;
+        size_t i = (w.size() * static_cast<size_t>(p) + 99) / 100;
+        return w[i > 0 ? i - 1 : 0];
+    };
+    p50 = pct(50);
+    p90 = pct(90);
+    p99 = pct(99);
+    max = w.empty() ? 0 : w.back();
+}
+
+/**
+ * @brief Snapshot of group counters with nearest-rank percentiles of the queue wait.
+ */
+Park::GroupStats Park::group_stats() {
+    std::lock_guard<std::mutex> lk(group_stats_mu);
+    GroupStats st = group_st;
+    wait_percentiles(group_waits_ms, st.wait_p50_ms, st.wait_p90_ms, st.wait_p99_ms, st.wait_max_ms);
+    return st;
+}
+
+/**
+ * @brief Snapshot of entry counters with nearest-rank percentiles of the admission wait.
+ */
+Park::EntryStats Park::entry_stats() {
+    std::lock_guard<std::mutex> lk(entry_stats_mu);
+    EntryStats st = entry_st;
+    wait_percentiles(entry_waits_ms, st.wait_p50_ms, st.wait_p90_ms, st.wait_p99_ms, st.wait_max_ms);
+    return st;
+}
+
+/**
+ * @brief Random route, or the cheaper one by route_cost_ms() (random on a tie).
+ */
+int Park::choose_route(RngStream& rng, int k, bool vip) {
+    int route;
+    if (cfg.route_policy == "congestion") {
+        int64_t c1 = route_cost_ms(1, k, vip);
+        int64_t c2 = route_cost_ms(2, k, vip);
+        route = (c1 < c2) ? 1 : (c2 < c1) ? 2 : rng.uniform_int(1, 2);
+    } else {
+        route = rng.uniform_int(1, 2);
     }
-    return g;
+    route_picks[route - 1].fetch_add(1);
+    return route;
 }
 
 /**
- * @brief Report tourist exit to cashier logger.
+ * @brief Queue-ahead estimate per attraction; the ferry also pays for coming to our bank.
+ *
+ * Route 1 crosses the bridge and the ferry FORWARD, route 2 BACKWARD; the tower is
+ * common to both. The snapshot is taken now, so it mostly informs the first hop.
+ */
+int64_t Park::route_cost_ms(int route, int k, bool vip) {
+    const int b = route - 1;   // indeks kierunku = brzeg odpływu promu
+    const Direction d = (route == 1) ? Direction::FORWARD : Direction::BACKWARD;
+
+    // Most: VIP nie omija kolejki. Przed nami nasz kierunek, a jeśli most idzie
+    // w drugą stronę - także ci, którzy na nim są i czekają w tamtą.
+    int64_t bridge_avg = bridge_svc_ms.get((cfg.bridge_min_ms + cfg.bridge_max_ms) / 2);
+    Bridge::Snapshot bs = bridge.snapshot();
+    int bridge_ahead = bs.queued[b];
+    if (bs.count > 0 && bs.dir != d) bridge_ahead += bs.count + bs.queued[1 - b];
+    int64_t bridge_ms = bridge_avg * (bridge_ahead + k) / cfg.X1 + bridge_avg;
+
+    int64_t tower_avg = tower_svc_ms.get((cfg.tower_min_ms + cfg.tower_max_ms) / 2);
+    Tower::Snapshot ts = tower.snapshot();
+    int tower_ahead = ts.waiting_vip + (vip ? 0 : ts.waiting_norm);
+    int64_t tower_ms = tower_avg * (tower_ahead + k) / cfg.X2 + tower_avg;
+
+    // Prom: kursy potrzebne, by zabrać kolejkę przed nami, plus dopłynięcie do naszego brzegu.
+    const int64_t cross = cfg.ferry_T_ms;
+    Ferry::Snapshot fs = ferry.snapshot();
+    int seats_ahead = fs.waiting_vip[b] + (vip ? 0 : fs.waiting_norm[b]);
+    int64_t trips = (seats_ahead + k + cfg.X3 - 1) / cfg.X3;
+    int64_t first;
+    if (fs.crossing) first = (fs.bank == b) ? cross * 3 / 2 : cross / 2;
+    else first = (fs.bank == b) ? 0 : cross;
+    int64_t ferry_ms = first + (trips - 1) * 2 * cross + cross;
+
+    return bridge_ms + tower_ms + ferry_ms;
+}
+
+/**
+ * @brief Queue the exit for the exit desk and wake it.
  */
 void Park::report_exit(int tourist_id) {
     {
         std::lock_guard<std::mutex> lk(exit_mu);
-        exit_ids.push_back(tourist_id);
+        exit_reports.push_back(ExitReport{tourist_id, std::chrono::steady_clock::now(), clock.now_ms()});
+        exit_cv.notify_all();
     }
     exited.fetch_add(1);
-    exit_cv.notify_one();
 }
 
 /**
- * @brief Cashier thread loop controlling entry limit N and logging exits.
+ * @brief Take all pending reports at once, log them outside the lock and note their latency.
  */
-void Park::cashier_loop() {
-    log.log_ts("CASHIER", "START");
+CoTask Park::exit_desk_loop() {
+    std::vector<ExitReport> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lk(exit_mu);
+            while (exit_reports.empty() && !exit_stop) co_await exit_cv.wait(lk);
+            if (exit_reports.empty()) break;
+            batch.assign(exit_reports.begin(), exit_reports.end());
+            exit_reports.clear();
+        }
 
-    while (open.load() || !entry_vip.empty() || !entry_norm.empty()) {
-        Tourist* t = dequeue_for_cashier();
-        if (!t) continue;
+        for (const ExitReport& r : batch) bus.emit(CashierExit{r.id});
 
-        int current = entered.load();
-        if (current >= cfg.N) {
-            log.log_ts("CASHIER", "REJECT id=" + std::to_string(t->id) + " reason=LIMIT_N");
-            t->on_rejected();
-            continue;
+        auto now = std::chrono::steady_clock::now();
+        int64_t now_sim = clock.now_ms();
+        std::lock_guard<std::mutex> lk(exit_mu);
+        ++exit_st.batches;
+        for (const ExitReport& r : batch) {
+            int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(now - r.t).count();
+            ++exit_st.logged;
+            exit_st.lat_sum_us += us;
+            exit_st.lat_max_us = std::max(exit_st.lat_max_us, us);
+            exit_st.lat_max_sim_ms = std::max(exit_st.lat_max_sim_ms, now_sim - r.t_sim_ms);
         }
+    }
+
+    std::lock_guard<std::mutex> lk(exit_mu);
+    exit_done = true;
+    exit_done_cv.notify_all();
+}
 
-        int after = entered.fetch_add(1) + 1;
+/**
+ * @brief Copy of the exit desk counters.
+ */
+Park::ExitStats Park::exit_stats() {
+    std::lock_guard<std::mutex> lk(exit_mu);
+    return exit_st;
+}
 
-        std::ostringstream oss;
-        oss << "ENTER id=" << t->id
-            << " age=" << t->age
-            << " vip=" << (t->vip ? 1 : 0)
-            << " count=" << after << "/" << cfg.N
-            << " pay=" << ((t->age < 7 || t->vip) ? 0 : 1);
-        log.log_ts("CASHIER", oss.str());
+/**
+ * @brief Cashier loop: admit batches under the shared limit N.
+ */
+CoTask Park::cashier_loop(int c) {
+    bus.emit(CashierStart{});
 
-        t->on_admitted();
+    std::vector<Tourist*> batch;
+    batch.reserve(ENTRY_BATCH);
+    while (true) {
+        co_await dequeue_for_cashier(c, batch);
+        if (batch.empty()) break;
+
+        for (Tourist* t : batch) {
+            if (cfg.cashier_ms > 0) co_await co_sleep(cfg.cashier_ms);
+            int64_t now = clock.now_ms();
+            int after = try_admit();
+            if (after == 0) {
+                bus.emit(CashierReject{t->id});
+                {
+                    std::lock_guard<std::mutex> lk(entry_stats_mu);
+                    ++entry_st.rejected;
+                }
+                t->on_rejected();
+                continue;
+            }
 
-        {
-            std::unique_lock<std::mutex> lk(exit_mu);
-            while (!exit_ids.empty()) {
-                int id = exit_ids.front();
-                exit_ids.pop_front();
-                log.log_ts("CASHIER", "EXIT id=" + std::to_string(id));
+            {
+                std::lock_guard<std::mutex> lk(entry_stats_mu);
+                ++entry_st.admitted;
+                entry_waits_ms.push_back(static_cast<int>(now - t->entry_since_ms));
             }
-        }
-    }
 
-    {
-        std::unique_lock<std::mutex> lk(exit_mu);
-        while (!exit_ids.empty()) {
-            int id = exit_ids.front();
-            exit_ids.pop_front();
-            log.log_ts("CASHIER", "EXIT id=" + std::to_string(id));
+            bus.emit(CashierEnter{t->id, t->age, t->vip, after, cfg.N, (t->age < 7 || t->vip) ? 0 : 1});
+            if (!t->vip && cfg.guided()) group_pending.fetch_add(1);   // przewodnicy czekają, aż dołączy do group_q
+            t->on_admitted();
         }
     }
 
-    log.log_ts("CASHIER", "STOP");
+    // Ostatni kasjer: przewodnicy mogą skończyć, gdy wpuszczeni dołączą do kolejki grup.
+    if (cashiers_live.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lk(group_mu);
+        group_cv.notify_all();
+    }
+    bus.emit(CashierStop{});
 }
 
 /**
- * @brief Guide thread loop forming groups, assigning guardians, driving routes.
+ * @brief Guide loop forming groups, assigning guardians, driving routes.
  */
-void Park::guide_loop(int guide_id) {
+CoTask Park::guide_loop(int guide_id, bool elastic) {
     int group_seq = 0;
-    log.log_ts("GUIDE", "START guide=" + std::to_string(guide_id));
+    RngStream rng(cfg.seed, RngStream::GUIDE, static_cast<uint64_t>(guide_id));
+    bus.emit(GuideStart{guide_id});
+    const int64_t duty_from = clock.now_ms();
 
     while (true) {
-        auto members = dequeue_group(cfg.M);
+        std::vector<Tourist*> members;
+        co_await dequeue_group(cfg.M, members, elastic);
         if (members.empty()) {
-            if (!open.load()) break;
+            if (groups_closed()) break;
+            if (elastic) {
+                int left = guides_active.fetch_sub(1) - 1;
+                {
+                    std::lock_guard<std::mutex> lk(group_stats_mu);
+                    ++group_st.scale_downs;
+                    group_st.guide_duty_ms += clock.now_ms() - duty_from;
+                }
+                bus.emit(GuideScaleDown{guide_id, left});
+                bus.emit(GuideStop{guide_id});
+                co_return;
+            }
             continue;
         }
 
@@ -439,109 +1038,135 @@ void Park::guide_loop(int guide_id) {
             else children.push_back(t);
         }
 
+        // compose: wszystkie dzieci <= 5 dostaje jeden opiekun (i tak nie wejdzie na wieżę),
+        // starsze dzieci pozostali dorośli po kolei - ich podopieczni nie tracą wieży.
+        const bool compose = (cfg.group_policy == "compose");
+        int next_adult = 0;
+        int guard_none = 0;
         for (auto* c : children) {
             if (adults.empty()) {
                 c->set_guardian(nullptr, (c->age <= 5));
-                log.log_ts("GUARD",
-                           "GUARD_NONE child=" + std::to_string(c->id) +
-                           " age=" + std::to_string(c->age) +
-                           " gid=" + std::to_string(gid));
+                bus.emit(GuardNone{c->id, c->age, gid});
+                ++guard_none;
             } else {
-                int idx = rand_int(0, static_cast<int>(adults.size()) - 1);
+                int n_adults = static_cast<int>(adults.size());
+                int idx;
+                if (!compose) idx = rng.uniform_int(0, n_adults - 1);
+                else if (c->age <= 5 || n_adults == 1) idx = 0;
+                else idx = 1 + (next_adult++ % (n_adults - 1));
                 Tourist* g = adults[idx];
                 c->set_guardian(g, (c->age <= 5));
-                log.log_ts("GUARD",
-                           "GUARD_ASSIGN child=" + std::to_string(c->id) +
-                           " age=" + std::to_string(c->age) +
-                           " guardian=" + std::to_string(g->id) +
-                           " gid=" + std::to_string(gid));
+                bus.emit(GuardAssign{c->id, c->age, g->id, gid});
             }
         }
 
-        int route = rand_int(1, 2);
+        int route = choose_route(rng, static_cast<int>(members.size()), false);
         group->route = route;
 
-        log.log_ts("GUIDE",
-                   "GROUP_START guide=" + std::to_string(guide_id) +
-                   " gid=" + std::to_string(gid) +
-                   " route=" + std::to_string(route));
+        bus.emit(GuideGroupStart{guide_id, gid, route});
+        int64_t busy_from = clock.now_ms();
 
         bool has_child_u12 = false;
         for (auto* t : members) if (t->age < 12) { has_child_u12 = true; break; }
+        {
+            std::lock_guard<std::mutex> lk(group_stats_mu);
+            if (has_child_u12) ++group_st.slow_groups;
+            group_st.guard_none += guard_none;
+        }
 
-        auto do_segment_sleep = [&] {
-            int base = rand_int(cfg.segment_min_ms, cfg.segment_max_ms);
+        auto segment_ms = [&] {
+            int base = rng.uniform_int(cfg.segment_min_ms, cfg.segment_max_ms);
             if (has_child_u12) base = (base * 3) / 2;
-            std::this_thread::sleep_for(std::chrono::milliseconds(base));
+            return base;
         };
 
         auto maybe_signal2 = [&]() {
-            if (rand01() < cfg.signal2_prob) {
-                log.log_ts("GUIDE", "SIGNAL2 guide=" + std::to_string(guide_id) + " gid=" + std::to_string(gid));
+            if (rng.uniform01() < cfg.signal2_prob) {
+                bus.emit(GuideSignal2{guide_id, gid});
                 for (auto* t : members) t->abort_to_k.store(true);
             }
         };
 
         auto maybe_signal1 = [&]() {
-            if (rand01() < cfg.signal1_prob) {
-                log.log_ts("GUIDE", "SIGNAL1 guide=" + std::to_string(guide_id) + " gid=" + std::to_string(gid));
+            if (rng.uniform01() < cfg.signal1_prob) {
+                bus.emit(GuideSignal1{guide_id, gid});
                 for (auto* t : members) t->tower_evacuate.store(true);
             }
         };
 
-        auto step_all = [&](Step s) {
+        // Lambdy-korutyny żyją w ramce guide_loop() i są od razu co_await-owane.
+        auto step_all = [&](Step s) -> CoTask {
             group->begin_step(s);
             for (auto* t : members) t->set_step(s);
-            group->wait_step_done();
+            co_await group->wait_step_done();
         };
 
-        auto segment = [&](const char* from, const char* to) -> bool {
+        // false = grupa zawraca do K (sygnał 2)
+        bool go_on = true;
+        auto segment = [&](char from, char to) -> CoTask {
             maybe_signal2();
             if (std::any_of(members.begin(), members.end(),
                             [](Tourist* t){ return t->abort_to_k.load(); })) {
-                step_all(Step::RETURN_K);
-                return false;
+                co_await step_all(Step::RETURN_K);
+                go_on = false;
+                co_return;
             }
-            log.log_ts("GUIDE", std::string("SEGMENT ") + from + "->" + to + " gid=" + std::to_string(gid));
-            do_segment_sleep();
-            return true;
+            bus.emit(GuideSegment{from, to, gid});
+            co_await co_sleep(segment_ms());
         };
 
         if (route == 1) {
-            if (!segment("K", "A")) goto done;
-            step_all(Step::GO_A);
+            co_await segment('K', 'A');
+            if (!go_on) goto done;
+            co_await step_all(Step::GO_A);
 
-            if (!segment("A", "B")) goto done;
-            step_all(Step::GO_B);
+            co_await segment('A', 'B');
+            if (!go_on) goto done;
+            co_await step_all(Step::GO_B);
             maybe_signal1();
 
-            if (!segment("B", "C")) goto done;
-            step_all(Step::GO_C);
+            co_await segment('B', 'C');
+            if (!go_on) goto done;
+            co_await step_all(Step::GO_C);
 
-            if (!segment("C", "K")) goto done;
-            step_all(Step::RETURN_K);
+            co_await segment('C', 'K');
+            if (!go_on) goto done;
+            co_await step_all(Step::RETURN_K);
         } else {
-            if (!segment("K", "C")) goto done;
-            step_all(Step::GO_C);
+            co_await segment('K', 'C');
+            if (!go_on) goto done;
+            co_await step_all(Step::GO_C);
 
-            if (!segment("C", "B")) goto done;
-            step_all(Step::GO_B);
+            co_await segment('C', 'B');
+            if (!go_on) goto done;
+            co_await step_all(Step::GO_B);
             maybe_signal1();
 
-            if (!segment("B", "A")) goto done;
-            step_all(Step::GO_A);
+            co_await segment('B', 'A');
+            if (!go_on) goto done;
+            co_await step_all(Step::GO_A);
 
-            if (!segment("A", "K")) goto done;
-            step_all(Step::RETURN_K);
+            co_await segment('A', 'K');
+            if (!go_on) goto done;
+            co_await step_all(Step::RETURN_K);
         }
 
     done:
         group->begin_step(Step::EXIT);
         for (auto* t : members) t->set_step(Step::EXIT);
-        group->wait_step_done();
+        co_await group->wait_step_done();
 
-        log.log_ts("GUIDE", "GROUP_END guide=" + std::to_string(guide_id) + " gid=" + std::to_string(gid));
+        bus.emit(GuideGroupEnd{guide_id, gid});
+        {
+            std::lock_guard<std::mutex> lk(group_stats_mu);
+            group_st.guide_busy_ms += clock.now_ms() - busy_from;
+        }
     }
 
-    log.log_ts("GUIDE", "STOP guide=" + std::to_string(guide_id));
+    guides_active.fetch_sub(1);
+    {
+        std::lock_guard<std::mutex> lk(group_stats_mu);
+        group_st.guide_duty_ms += clock.now_ms() - duty_from;
+    }
+    bus.emit(GuideStop{guide_id});
 }
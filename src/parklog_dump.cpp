@@ -0,0 +1,42 @@
+// parklog_dump.cpp
+// Zamienia binarny log parku (--log-format=binary) na tekst identyczny
+// z logs/park.log.
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "event_log.hpp"
+
+int main(int argc, char** argv) {
+    const char* in_path = (argc > 1) ? argv[1] : "logs/park.bin";
+    if (argc > 2 || (argc > 1 && std::strcmp(argv[1], "--help") == 0)) {
+        std::fprintf(stderr, "usage: %s [logs/park.bin] > park.log\n", argv[0]);
+        return 2;
+    }
+
+    std::FILE* in = std::fopen(in_path, "rb");
+    if (!in) {
+        std::perror(in_path);
+        return 1;
+    }
+
+    static char in_buf[1 << 16];
+    static char out_buf[1 << 16];
+    std::setvbuf(in, in_buf, _IOFBF, sizeof(in_buf));
+    std::setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+
+    EvReader rd(in);
+    EvRecord r;
+    while (rd.next(r)) {
+        std::string line = EvReader::to_text(r);
+        std::fwrite(line.data(), 1, line.size(), stdout);
+    }
+    std::fclose(in);
+    std::fflush(stdout);
+
+    if (!rd.error().empty()) {
+        std::fprintf(stderr, "%s: %s\n", in_path, rd.error().c_str());
+        return 1;
+    }
+    return 0;
+}
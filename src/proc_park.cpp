@@ -0,0 +1,533 @@
+#include "proc_park.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <csignal>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "events.hpp"
+#include "sim_clock.hpp"
+
+/**
+ * @brief Lock-free view of a counter living in the shared segment.
+ */
+template <class T>
+static std::atomic_ref<T> shared(T& field) {
+    return std::atomic_ref<T>(field);
+}
+
+/**
+ * @brief Per-run token file (ftok keys), arena with the shared state, capacities or servers.
+ */
+ProcessPark::ProcessPark(const Config& cfg, EventBus& bus)
+    : cfg_(cfg), bus_(bus),
+      token_("/tmp/park-sim." + std::to_string(getpid()) + ".ipc") {
+    // Rekordów tyle, ilu może wejść (limit N) - pula nigdy się nie wyczerpie.
+    const uint32_t recs = static_cast<uint32_t>(cfg.N > 0 ? cfg.N : 1);
+    const size_t bytes = 4096 + sizeof(ProcShared) + sizeof(ShmRoster) + ShmPool<ShmTouristRec>::bytes_for(recs);
+    if (arena_.create(token_.c_str(), 'S', bytes) < 0) return;
+    sh_ = arena_.construct<ProcShared>();
+    roster_ = arena_.construct<ShmRoster>();
+    recs_ = arena_.construct<ShmPool<ShmTouristRec>>(arena_, recs);
+    if (!sh_ || !roster_ || !recs_ || recs_->capacity() != recs) {
+        std::fprintf(stderr, "arena: %zu bytes too small\n", bytes);
+        return;
+    }
+
+    calibrate();
+    servers_ = (cfg.attractions == "server");
+    if (servers_) {
+        if (!start_server(Attraction::BRIDGE)) return;
+        if (!start_server(Attraction::TOWER)) return;
+        if (!start_server(Attraction::FERRY)) return;
+    } else {
+        if (!make_caps()) return;
+        if (!make_sem(bridge_turn_, 'T', 1)) return;
+        if (!make_sem(bridge_empty_, 'E', 1)) return;
+        if (!make_sem(bridge_mx_[0], 'F', 1)) return;
+        if (!make_sem(bridge_mx_[1], 'G', 1)) return;
+    }
+    ok_ = true;
+}
+
+/**
+ * @brief Wait for the children, then drop every IPC object of the run.
+ */
+ProcessPark::~ProcessPark() {
+    wait_all();
+    stop_servers();
+    for (auto& sv : srv_) {
+        if (sv.req) sv.req->remove();
+        if (sv.res) sv.res->remove();
+    }
+    arena_.remove();
+    caps_.remove();
+    bridge_turn_.remove();
+    bridge_empty_.remove();
+    bridge_mx_[0].remove();
+    bridge_mx_[1].remove();
+    unlink(token_.c_str());
+}
+
+/**
+ * @brief Create the semaphore; recreate it when a stale one with another value is found.
+ */
+bool ProcessPark::make_sem(SysVSemaphore& s, int proj_id, int value) {
+    if (s.create_or_open(token_.c_str(), proj_id, value) < 0) return false;
+    if (s.value() == value) return true;
+    return s.remove() == 0 && s.create_or_open(token_.c_str(), proj_id, value) == 0;
+}
+
+/**
+ * @brief Same as make_sem() for the three capacities in one set.
+ */
+bool ProcessPark::make_caps() {
+    const int caps[3] = {cfg_.X1, cfg_.X2, cfg_.X3};
+    if (caps_.create_or_open(token_.c_str(), 'A', caps) < 0) return false;
+    bool fresh = true;
+    for (int i = 0; i < 3; ++i) fresh = fresh && caps_.value(i) == caps[i];
+    if (fresh) return true;
+    return caps_.remove() == 0 && caps_.create_or_open(token_.c_str(), 'A', caps) == 0;
+}
+
+/**
+ * @brief Fresh request/reply channels (stale messages dropped), then fork the server process.
+ */
+bool ProcessPark::start_server(Attraction a) {
+    const int i = static_cast<int>(a);
+    ServerProc& sv = srv_[i];
+    sv.req = make_msg_channel(cfg_.ipc);
+    sv.res = make_msg_channel(cfg_.ipc);
+    if (sv.req->reset_queue(token_.c_str(), 'a' + i) < 0) return false;
+    if (sv.res->reset_queue(token_.c_str(), 'x' + i) < 0) return false;
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork(server)");
+        return false;
+    }
+    if (pid == 0) AttractionServer(a, cfg_, bus_, *sv.req, *sv.res, sh_->srv[i]).run();
+    sv.pid = pid;
+    return true;
+}
+
+/**
+ * @brief Servers exit on REQ_STOP; only then are their counters final.
+ */
+void ProcessPark::stop_servers() {
+    for (auto& sv : srv_) {
+        if (sv.pid <= 0) continue;
+        BridgeReqMsg m{1, static_cast<int32_t>(BridgeMsgKind::REQ_STOP), -1, 0, 0, 0, 0, 0};
+        if (sv.req->send_req(m) < 0) kill(sv.pid, SIGTERM);
+        int status = 0;
+        while (waitpid(sv.pid, &status, 0) < 0 && errno == EINTR) {}
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ++st_.child_failures;
+        sv.pid = -1;
+    }
+}
+
+/**
+ * @brief Average cost of one semop without contention (no wait in the kernel).
+ */
+void ProcessPark::calibrate() {
+    constexpr int kPairs = 1000;
+    SysVSemaphore s;
+    if (!make_sem(s, 'K', 1)) return;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kPairs; ++i) {
+        s.down();
+        s.up();
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - t0).count();
+    st_.semop_ns = ns / (2 * kPairs);
+    s.remove();
+}
+
+/**
+ * @brief fork(); the child runs visit() and never returns here.
+ */
+bool ProcessPark::spawn(int id, int age, bool vip) {
+    while (true) {
+        auto t0 = std::chrono::steady_clock::now();
+        pid_t pid = fork();
+        if (pid == 0) visit(id, age, vip);
+        if (pid > 0) {
+            int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - t0).count();
+            ++st_.forks;
+            st_.fork_us_sum += us;
+            if (us > st_.fork_us_max) st_.fork_us_max = us;
+            if (++live_ > st_.peak_live) st_.peak_live = live_;
+            return true;
+        }
+        // Limit procesów: zwolnij miejsce, czekając na któregoś z turystów.
+        if (errno != EAGAIN || live_ == 0) {
+            perror("fork");
+            return false;
+        }
+        ++st_.fork_retries;
+        reap_one(true);
+    }
+}
+
+/**
+ * @brief waitpid() one child; counts abnormal exits.
+ */
+bool ProcessPark::reap_one(bool block) {
+    int status = 0;
+    pid_t pid;
+    do {
+        pid = waitpid(-1, &status, block ? 0 : WNOHANG);
+    } while (pid < 0 && errno == EINTR);
+    if (pid <= 0) return false;
+    bool failed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    if (failed) ++st_.child_failures;
+    for (auto& sv : srv_) {
+        if (sv.pid != pid) continue;
+        // Serwer skończył przed REQ_STOP: jego klienci już się nie doczekają.
+        fprintf(stderr, "attraction server %d exited early\n", static_cast<int>(pid));
+        sv.pid = -1;
+        return true;
+    }
+    --live_;
+    return true;
+}
+
+/**
+ * @brief Collect whatever already finished.
+ */
+void ProcessPark::reap() {
+    while (live_ > 0 && reap_one(false)) {}
+}
+
+/**
+ * @brief Collect all children.
+ */
+void ProcessPark::wait_all() {
+    while (live_ > 0 && reap_one(true)) {}
+}
+
+/**
+ * @brief Parent-side counters plus a snapshot of the shared segment.
+ */
+ProcessPark::Stats ProcessPark::stats() const {
+    Stats st = st_;
+    if (!sh_) return st;
+    st.entered = shared(sh_->stats.tourists_entered).load();
+    st.exited = shared(sh_->stats.tourists_exited).load();
+    st.bridge_crossings = shared(sh_->stats.bridge_crossings).load();
+    st.rejected = shared(sh_->rejected).load();
+    st.tower_visits = shared(sh_->tower_visits).load();
+    st.ferry_rides = shared(sh_->ferry_rides).load();
+    st.route_picks[0] = shared(sh_->route_picks[0]).load();
+    st.route_picks[1] = shared(sh_->route_picks[1]).load();
+    st.semops = shared(sh_->semops).load();
+    st.cap_waits = shared(sh_->cap_waits).load();
+    st.arena_used = arena_.used();
+    st.arena_size = arena_.size();
+    st.recs_capacity = recs_->capacity();
+    st.recs_peak = recs_->peak();
+    roster_->mu.lock();
+    st.peak_in_park = roster_->peak_in_park;
+    for (int i = 0; i < 4; ++i) st.peak_at[i] = roster_->peak_at[i];
+    roster_->mu.unlock();
+    st.roster_contended = roster_->mu.contended();
+    st.servers = servers_;
+    for (int i = 0; i < 3; ++i) {
+        st.srv[i] = sh_->srv[i];
+        for (auto* ch : {srv_[i].req.get(), srv_[i].res.get()}) {
+            auto* ring = dynamic_cast<const ShmRingChannel*>(ch);
+            if (!ring) continue;
+            ShmRingChannel::Counters c = ring->counters();
+            st.ring[i].futex_waits += c.futex_waits;
+            st.ring[i].futex_wakes += c.futex_wakes;
+        }
+    }
+    return st;
+}
+
+// ------------------------- proces turysty -------------------------
+
+/**
+ * @brief down(); a failed semop (e.g. the set was removed) ends the tourist process.
+ */
+void ProcessPark::P(SysVSemaphore& s, bool undo) {
+    shared(sh_->semops).fetch_add(1, std::memory_order_relaxed);
+    if (s.down(undo) < 0) _exit(1);
+}
+
+/**
+ * @brief up(); see P().
+ */
+void ProcessPark::V(SysVSemaphore& s, bool undo) {
+    shared(sh_->semops).fetch_add(1, std::memory_order_relaxed);
+    if (s.up(undo) < 0) _exit(1);
+}
+
+/**
+ * @brief Usually one semop; a party that does not fit now pays a second, blocking one.
+ */
+void ProcessPark::claim(int cap, int k) {
+    shared(sh_->semops).fetch_add(1, std::memory_order_relaxed);
+    int rc = caps_.try_acquire(cap, k);
+    if (rc == 1) {
+        shared(sh_->cap_waits).fetch_add(1, std::memory_order_relaxed);
+        shared(sh_->semops).fetch_add(1, std::memory_order_relaxed);
+        rc = caps_.acquire(cap, k);
+    }
+    if (rc != 0) _exit(1);
+}
+
+/**
+ * @brief release(); see claim().
+ */
+void ProcessPark::unclaim(int cap, int k) {
+    shared(sh_->semops).fetch_add(1, std::memory_order_relaxed);
+    if (caps_.release(cap, k) < 0) _exit(1);
+}
+
+/**
+ * @brief total - current value (GETVAL; only for the log line).
+ */
+int ProcessPark::occupied(int cap, int total) const {
+    return total - caps_.value(cap);
+}
+
+/**
+ * @brief Request/reply round trip; the reply carries its send time for the response latency.
+ */
+void ProcessPark::call(Attraction a, int id, Direction d, bool vip, int k) {
+    ServerProc& sv = srv_[static_cast<int>(a)];
+    ServerStats& st = sh_->srv[static_cast<int>(a)];
+    const int pid = static_cast<int>(getpid());
+    const int64_t t0 = mono_ns();
+    BridgeReqMsg m{1, static_cast<int32_t>(BridgeMsgKind::REQ_CROSS), id, pid,
+                   static_cast<int32_t>(d), vip ? 1 : 0, k, t0};
+    if (sv.req->send_req(m) < 0) _exit(1);
+    BridgeResMsg r{};
+    while (sv.res->recv_done(id, pid, &r) < 0) {
+        if (errno != EINTR) _exit(1);
+    }
+    const int64_t now = mono_ns();
+    const int64_t lat = now - r.t_ns;
+    shared(st.replies).fetch_add(1);
+    shared(st.res_lat_ns_sum).fetch_add(lat);
+    shared(st.rtt_ns_sum).fetch_add(now - t0);
+    auto mx = shared(st.res_lat_ns_max);
+    int64_t cur = mx.load();
+    while (lat > cur && !mx.compare_exchange_weak(cur, lat)) {}
+}
+
+/**
+ * @brief Fire-and-forget release.
+ */
+void ProcessPark::leave(Attraction a, int id, int k) {
+    BridgeReqMsg m{1, static_cast<int32_t>(BridgeMsgKind::REQ_LEAVE), id, static_cast<int32_t>(getpid()),
+                   0, 0, k, mono_ns()};
+    if (srv_[static_cast<int>(a)].req->send_req(m) < 0) _exit(1);
+}
+
+/**
+ * @brief Turnstile keeps arrival order; the first walker of a direction takes the bridge, the last one frees it.
+ */
+void ProcessPark::cross_bridge(int id, Direction d, int k, RngStream& rng) {
+    if (servers_) {
+        call(Attraction::BRIDGE, id, d, false, k);
+        roster_move(Spot::BRIDGE);
+        SimClock::global().sleep_ms(rng.uniform_int(cfg_.bridge_min_ms, cfg_.bridge_max_ms));
+        roster_move(Spot::PATH);
+        leave(Attraction::BRIDGE, id, k);
+        shared(sh_->stats.bridge_crossings).fetch_add(1);
+        return;
+    }
+    const int b = (d == Direction::FORWARD) ? 0 : 1;
+    std::atomic_ref<uint32_t> on(sh_->bridge_on[b]);
+
+    P(bridge_turn_);
+    P(bridge_mx_[b]);
+    if (on.fetch_add(1) == 0) {
+        P(bridge_empty_, false);   // zwolni go ostatni schodzący - inny proces
+        bus_.emit(BridgeDirSet{d});
+    }
+    V(bridge_mx_[b]);
+    V(bridge_turn_);
+
+    claim(CAP_BRIDGE, k);
+    roster_move(Spot::BRIDGE);
+    bus_.emit(BridgeEnter{id, d, occupied(CAP_BRIDGE, cfg_.X1), cfg_.X1});
+    SimClock::global().sleep_ms(rng.uniform_int(cfg_.bridge_min_ms, cfg_.bridge_max_ms));
+    bus_.emit(BridgeLeave{id, occupied(CAP_BRIDGE, cfg_.X1) - k, cfg_.X1});   // przed zwolnieniem: log w kolejności zajęć
+    roster_move(Spot::PATH);
+    unclaim(CAP_BRIDGE, k);
+
+    P(bridge_mx_[b]);
+    if (on.fetch_sub(1) == 1) V(bridge_empty_, false);
+    V(bridge_mx_[b]);
+    shared(sh_->stats.bridge_crossings).fetch_add(1);
+}
+
+/**
+ * @brief Wait for k of X2 places, stay, leave.
+ */
+void ProcessPark::visit_tower(int id, bool vip, int k, RngStream& rng) {
+    if (servers_) {
+        call(Attraction::TOWER, id, Direction::NONE, vip, k);
+        roster_move(Spot::TOWER);
+        SimClock::global().sleep_ms(rng.uniform_int(cfg_.tower_min_ms, cfg_.tower_max_ms));
+        roster_move(Spot::PATH);
+        leave(Attraction::TOWER, id, k);
+        shared(sh_->tower_visits).fetch_add(1);
+        return;
+    }
+    claim(CAP_TOWER, k);
+    roster_move(Spot::TOWER);
+    bus_.emit(TowerEnter{id, vip, occupied(CAP_TOWER, cfg_.X2), cfg_.X2, 0, 0, 0});
+    SimClock::global().sleep_ms(rng.uniform_int(cfg_.tower_min_ms, cfg_.tower_max_ms));
+    bus_.emit(TowerLeave{id, occupied(CAP_TOWER, cfg_.X2) - k, cfg_.X2});
+    roster_move(Spot::PATH);
+    unclaim(CAP_TOWER, k);
+    shared(sh_->tower_visits).fetch_add(1);
+}
+
+/**
+ * @brief Board when k seats are free and cross; no fixed departures in this mode.
+ */
+void ProcessPark::ride_ferry(int id, bool vip, Direction d, int k) {
+    if (servers_) {
+        call(Attraction::FERRY, id, d, vip, k);   // odpowiedź dopiero po wysadzeniu (bez Spot::FERRY)
+        shared(sh_->ferry_rides).fetch_add(1);
+        return;
+    }
+    claim(CAP_FERRY, k);
+    roster_move(Spot::FERRY);
+    bus_.emit(FerryBoard{id, vip, d, occupied(CAP_FERRY, cfg_.X3), cfg_.X3, 0, 0, 0});
+    SimClock::global().sleep_ms(cfg_.ferry_T_ms);
+    bus_.emit(FerryUnboard{id, occupied(CAP_FERRY, cfg_.X3) - k, cfg_.X3});
+    roster_move(Spot::PATH);
+    unclaim(CAP_FERRY, k);
+    shared(sh_->ferry_rides).fetch_add(1);
+}
+
+/**
+ * @brief Record from the pool, pushed at the head of the roster list.
+ */
+void ProcessPark::roster_enter(int id, int age, bool vip, int k) {
+    ShmTouristRec* r = recs_->alloc();
+    if (!r) return;   // niemożliwe przy puli N, ale turysta i tak może iść
+    r->id = id;
+    r->pid = static_cast<int32_t>(getpid());
+    r->age = age;
+    r->k = k;
+    r->vip = vip ? 1 : 0;
+    r->at = Spot::PATH;
+
+    ShmRoster& ro = *roster_;
+    ro.mu.lock();
+    r->next = ro.head;
+    if (ro.head) ro.head->prev = r;
+    ro.head = r;
+    if (++ro.in_park > ro.peak_in_park) ro.peak_in_park = ro.in_park;
+    ro.at[0] += static_cast<uint32_t>(k);
+    ro.mu.unlock();
+    me_ = r;
+}
+
+/**
+ * @brief Move the places under the roster mutex and keep per-spot peaks.
+ */
+void ProcessPark::roster_move(Spot spot) {
+    if (!me_) return;
+    ShmRoster& ro = *roster_;
+    const uint32_t k = static_cast<uint32_t>(me_->k);
+    const int to = static_cast<int>(spot);
+    ro.mu.lock();
+    ro.at[static_cast<int>(me_->at)] -= k;
+    ro.at[to] += k;
+    if (ro.at[to] > ro.peak_at[to]) ro.peak_at[to] = ro.at[to];
+    me_->at = spot;
+    ro.mu.unlock();
+}
+
+/**
+ * @brief Unlink from the roster list and give the record back to the pool.
+ */
+void ProcessPark::roster_leave() {
+    if (!me_) return;
+    ShmRoster& ro = *roster_;
+    ro.mu.lock();
+    if (me_->prev) me_->prev->next = me_->next;
+    else ro.head = me_->next;
+    if (me_->next) me_->next->prev = me_->prev;
+    ro.at[static_cast<int>(me_->at)] -= static_cast<uint32_t>(me_->k);
+    --ro.in_park;
+    ro.mu.unlock();
+    recs_->free(me_);
+    me_ = nullptr;
+}
+
+/**
+ * @brief Whole visit of one tourist; ends the process with _exit (no parent destructors, no stdio flush).
+ */
+void ProcessPark::visit(int id, int age, bool vip) {
+    SimClock& clk = SimClock::global();
+    RngStream rng(cfg_.seed, RngStream::TOURIST, static_cast<uint64_t>(id));
+    bus_.emit(TouristArrive{id, age, vip});
+
+    // Bilet: ten sam limit N co Park::try_admit(), licznik w segmencie.
+    std::atomic_ref<uint64_t> sold(sh_->stats.tourists_entered);
+    uint64_t cur = sold.load();
+    const uint64_t limit = static_cast<uint64_t>(cfg_.N);
+    while (cur < limit && !sold.compare_exchange_weak(cur, cur + 1)) {}
+    if (cur >= limit) {
+        shared(sh_->rejected).fetch_add(1);
+        bus_.emit(CashierReject{id});
+        bus_.emit(TouristLeaveNoEntry{id});
+        _exit(0);
+    }
+    bus_.emit(CashierEnter{id, age, vip, static_cast<int>(cur + 1), cfg_.N, (age < 7 || vip) ? 0 : 1});
+
+    const int k = 1;   // bez procesu opiekuna nie ma partii - jedno miejsce
+    roster_enter(id, age, vip, k);
+
+    if (vip && age < 15) {
+        bus_.emit(VipDenyChild{id, age});
+    } else {
+        int route = rng.uniform_int(1, 2);
+        shared(sh_->route_picks[route - 1]).fetch_add(1);
+        if (vip) bus_.emit(VipStart{id, route});
+
+        const bool slow = age < 12;   // jak grupa z dzieckiem < 12: odcinki x1.5
+        auto segment = [&] {
+            int ms = rng.uniform_int(cfg_.segment_min_ms, cfg_.segment_max_ms);
+            clk.sleep_ms(slow ? (ms * 3) / 2 : ms);
+        };
+        auto tower = [&] {
+            if (age > 5) visit_tower(id, vip, k, rng);
+            else if (vip) bus_.emit(VipTowerSkip{id});
+            else bus_.emit(TowerDenyAge5{id});
+        };
+        const Direction d = (route == 1) ? Direction::FORWARD : Direction::BACKWARD;
+
+        segment();
+        if (route == 1) cross_bridge(id, d, k, rng);
+        else ride_ferry(id, vip, d, k);
+        segment();
+        tower();
+        segment();
+        if (route == 1) ride_ferry(id, vip, d, k);
+        else cross_bridge(id, d, k, rng);
+        segment();
+
+        if (vip) bus_.emit(VipEnd{id});
+    }
+
+    roster_leave();
+    shared(sh_->stats.tourists_exited).fetch_add(1);
+    bus_.emit(CashierExit{id});
+    _exit(0);
+}
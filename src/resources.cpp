@@ -1,123 +1,255 @@
 #include "resources.hpp"
 
-#include <sstream>
+#include <chrono>
+
 
 // ------------------------- BRIDGE (A) -------------------------
 
+static uint32_t br_count(uint32_t s) { return s & Bridge::COUNT_MASK; }
+static Direction br_dir(uint32_t s) { return static_cast<Direction>((s >> Bridge::DIR_SHIFT) & 3u); }
+static uint32_t br_pack(uint32_t count, Direction d, bool waiters) {
+    return count | (static_cast<uint32_t>(d) << Bridge::DIR_SHIFT) | (waiters ? Bridge::WAITERS : 0u);
+}
+static int br_idx(Direction d) { return d == Direction::BACKWARD ? 1 : 0; }
+
 /**
- * @brief Initialize bridge monitor with capacity and logger.
+ * @brief Initialize bridge monitor with capacity and event bus.
  */
-Bridge::Bridge(int cap_, Logger& log_) : cap(cap_), log(log_) {}
+Bridge::Bridge(int cap_, EventBus& bus_) : cap(cap_), bus(bus_) {}
 
 /**
- * @brief Enter bridge respecting direction and capacity constraints.
+ * @brief Enter bridge respecting direction and capacity; FIFO per direction.
  */
-void Bridge::enter(int tourist_id, Direction d) {
-    std::unique_lock<std::mutex> lk(mu);
-    cv.wait(lk, [&]{
-        bool dir_ok = (dir == Direction::NONE || dir == d);
-        bool cap_ok = (on_bridge < cap);
-        return dir_ok && cap_ok;
-    });
-
-    if (dir == Direction::NONE) {
-        dir = d;
-        std::ostringstream oss;
-        oss << "BRIDGE_DIR_SET dir=" << dir_str(dir);
-        log.log_ts("BRIDGE", oss.str());
+CoTask Bridge::enter(int tourist_id, Direction d) {
+    // Szybka ścieżka: nikt nie czeka, most niepusty w naszym kierunku, jest miejsce.
+    uint32_t s = state.load();
+    while (!(s & WAITERS) && br_count(s) > 0 && br_dir(s) == d &&
+           static_cast<int>(br_count(s)) < cap) {
+        if (state.compare_exchange_weak(s, s + 1)) {
+            fast_entries.fetch_add(1, std::memory_order_relaxed);
+            bus.emit(BridgeEnter{tourist_id, d, static_cast<int>(br_count(s)) + 1, cap});
+            co_return;
+        }
     }
 
-    ++on_bridge;
-    {
-        std::ostringstream oss;
-        oss << "ENTER id=" << tourist_id << " dir=" << dir_str(d)
-            << " occ=" << on_bridge << "/" << cap;
-        log.log_ts("BRIDGE", oss.str());
+    std::unique_lock<std::mutex> lk(mu);
+    s = state.load();
+    while (true) {
+        int c = static_cast<int>(br_count(s));
+        bool dir_ok = (c == 0 || br_dir(s) == d);
+        // Czeka ktoś z naprzeciwka: nie dokładamy osób w naszym kierunku, most ma się opróżnić.
+        bool queues_empty = queue[0].empty() && queue[1].empty();
+        if (queues_empty && dir_ok && c < cap) {
+            uint32_t ns = br_pack(c + 1, d, s & WAITERS);
+            if (!state.compare_exchange_weak(s, ns)) continue;
+            if (c == 0) bus.emit(BridgeDirSet{d});
+            bus.emit(BridgeEnter{tourist_id, d, c + 1, cap});
+            co_return;
+        }
+        // Ustaw WAITERS: od teraz stan zmienia się tylko pod mu.
+        if (state.compare_exchange_weak(s, s | WAITERS)) break;
     }
 
-    lk.unlock();
-    cv.notify_all();
+    Waiter w(tourist_id, d);
+    queue[br_idx(d)].push_back(&w);
+    queued_entries.fetch_add(1, std::memory_order_relaxed);
+
+    auto t0 = std::chrono::steady_clock::now();
+    while (!w.granted) {
+        co_await w.cv.wait(lk);
+        wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+    wait_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - t0).count(),
+                      std::memory_order_relaxed);
+    // BRIDGE_ENTER zalogował przekazujący (grant_locked).
 }
 
 /**
- * @brief Leave bridge; clears direction when last leaves.
+ * @brief Leave bridge; the last one out switches direction and wakes the other side.
  */
 void Bridge::leave(int tourist_id) {
+    uint32_t s = state.load();
+    while (!(s & WAITERS) && br_count(s) > 1) {
+        if (state.compare_exchange_weak(s, s - 1)) {
+            bus.emit(BridgeLeave{tourist_id, static_cast<int>(br_count(s)) - 1, cap});
+            return;
+        }
+    }
+
     std::unique_lock<std::mutex> lk(mu);
+    s = state.load();
+    uint32_t ns;
+    do {
+        uint32_t c = br_count(s);
+        ns = (c <= 1) ? (s & WAITERS) : s - 1;   // pusty most: kierunek NONE
+    } while (!state.compare_exchange_weak(s, ns));
+
+    int left = static_cast<int>(br_count(ns));
+    bus.emit(BridgeLeave{tourist_id, left, cap});
+    if (left == 0) {
+        last_dir = br_dir(s);
+        bus.emit(BridgeDirSet{Direction::NONE});
+    }
 
-    --on_bridge;
-    {
-        std::ostringstream oss;
-        oss << "LEAVE id=" << tourist_id << " occ=" << on_bridge << "/" << cap;
-        log.log_ts("BRIDGE", oss.str());
+    grant_locked();
+}
+
+/**
+ * @brief Hand slots directly to waiters; only granted waiters are woken.
+ */
+void Bridge::grant_locked() {
+    uint32_t s = state.load();
+    if (!(s & WAITERS)) return;   // przy WAITERS stan zmienia się tylko pod mu
+
+    int c = static_cast<int>(br_count(s));
+    Direction cur = br_dir(s);
+
+    if (c == 0) {
+        // Pusty most: najpierw strona przeciwna do tej, która właśnie zjechała.
+        Direction other = (last_dir == Direction::FORWARD) ? Direction::BACKWARD : Direction::FORWARD;
+        Direction same = (other == Direction::FORWARD) ? Direction::BACKWARD : Direction::FORWARD;
+        if (!queue[br_idx(other)].empty()) cur = other;
+        else if (!queue[br_idx(same)].empty()) cur = same;
+        else cur = Direction::NONE;
+        if (cur != Direction::NONE) bus.emit(BridgeDirSet{cur});
     }
 
-    if (on_bridge == 0) {
-        dir = Direction::NONE;
-        log.log_ts("BRIDGE", "BRIDGE_DIR_SET dir=NONE");
+    // Most zajęty, a druga strona czeka: bez dopuszczania - inaczej jeden kierunek
+    // mógłby ją zagłodzić. Ostatni schodzący odda most drugiej stronie.
+    bool opposite_waits = cur != Direction::NONE && !queue[1 - br_idx(cur)].empty();
+    if (cur != Direction::NONE && !(c > 0 && opposite_waits)) {
+        auto& q = queue[br_idx(cur)];
+        while (!q.empty() && c < cap) {
+            Waiter* w = q.front();
+            q.pop_front();
+            ++c;
+            w->granted = true;
+            bus.emit(BridgeEnter{w->tourist_id, cur, c, cap});
+            w->cv.notify_all();
+        }
     }
 
-    lk.unlock();
-    cv.notify_all();
+    bool waiters = !queue[0].empty() || !queue[1].empty();
+    state.store(br_pack(static_cast<uint32_t>(c), c > 0 ? cur : Direction::NONE, waiters));
 }
 
-// ------------------------- TOWER (B) -------------------------
+/**
+ * @brief Read the state word and queue lengths under mu.
+ */
+Bridge::Snapshot Bridge::snapshot() {
+    std::lock_guard<std::mutex> lk(mu);
+    uint32_t s = state.load();
+    Snapshot sn;
+    sn.count = static_cast<int>(br_count(s));
+    sn.dir = br_dir(s);
+    sn.queued[0] = static_cast<int>(queue[0].size());
+    sn.queued[1] = static_cast<int>(queue[1].size());
+    return sn;
+}
+
+// ------------------------- SLOT QUEUE -------------------------
 
 /**
- * @brief Initialize tower monitor with capacity and logger.
+ * @brief Give the ticket its number and queue it in its class.
  */
-Tower::Tower(int cap_, Logger& log_) : cap(cap_), log(log_) {}
+void SlotQueue::join(Ticket* t) {
+    t->no = next_no++;
+    if (t->vip) {
+        vip_q.push_back(t);
+        waiting_vip += t->k;
+    } else {
+        norm_q.push_back(t);
+        waiting_norm += t->k;
+    }
+}
 
 /**
- * @brief Enter tower as single visitor with VIP fairness logic.
+ * @brief Choose the class by VIP fairness, then admit its head only if it fits.
  */
-void Tower::enter(int tourist_id, bool vip) {
-    std::unique_lock<std::mutex> lk(mu);
+SlotQueue::Ticket* SlotQueue::next_grant() {
+    std::deque<Ticket*>* q = nullptr;
+    if (!vip_q.empty() && (norm_q.empty() || vip_streak < VIP_BURST)) q = &vip_q;
+    else if (!norm_q.empty()) q = &norm_q;
+    if (!q) return nullptr;
+
+    Ticket* t = q->front();
+    // Czoło czeka, nikt go nie wyprzedza. k <= cap gwarantuje Config (X2, X3 >= M).
+    if (used + t->k > cap) return nullptr;
+    return take(*q);
+}
 
-    if (vip) ++waiting_vip;
-    else     ++waiting_norm;
+/**
+ * @brief Head of either class (VIP first) that still fits in the free slots, or nullptr.
+ */
+SlotQueue::Ticket* SlotQueue::next_fill() {
+    for (auto* q : {&vip_q, &norm_q}) {
+        if (!q->empty() && used + q->front()->k <= cap) return take(*q);
+    }
+    return nullptr;
+}
 
-    {
-        std::ostringstream oss;
-        oss << "QUEUE_JOIN id=" << tourist_id
-            << " vip=" << (vip ? 1 : 0)
-            << " wait_vip=" << waiting_vip
-            << " wait_norm=" << waiting_norm;
-        log.log_ts("TOWER", oss.str());
+/**
+ * @brief Pop the head of @p q and account its slots.
+ */
+SlotQueue::Ticket* SlotQueue::take(std::deque<Ticket*>& q) {
+    Ticket* t = q.front();
+    q.pop_front();
+
+    used += t->k;
+    if (t->vip) {
+        waiting_vip -= t->k;
+        ++vip_streak;
+    } else {
+        waiting_norm -= t->k;
+        vip_streak = 0;
     }
+    return t;
+}
 
-    cv.wait(lk, [&]{
-        if (inside >= cap) return false;
+// ------------------------- TOWER (B) -------------------------
 
-        if (vip) {
-            if (waiting_norm > 0 && vip_streak >= VIP_BURST) return false;
-            return true;
+/**
+ * @brief Initialize tower monitor with capacity and event bus.
+ */
+Tower::Tower(int cap_, EventBus& bus_) : cap(cap_), bus(bus_), slots(cap_) {}
+
+/**
+ * @brief Hand free slots to the next tickets; logs ENTER on their behalf.
+ */
+void Tower::grant_locked() {
+    while (SlotQueue::Ticket* t = slots.next_grant()) {
+        if (t->group) {
+            bus.emit(TowerGroupEnter{t->id, t->k, t->vip, slots.used, cap, slots.waiting_vip,
+                                     slots.waiting_norm, slots.vip_streak});
         } else {
-            if (waiting_vip == 0) return true;
-            if (vip_streak >= VIP_BURST) return true;
-            return false;
+            bus.emit(TowerEnter{t->id, t->vip, slots.used, cap, slots.waiting_vip, slots.waiting_norm,
+                                slots.vip_streak});
         }
-    });
-
-    if (vip) --waiting_vip;
-    else     --waiting_norm;
-
-    ++inside;
-    if (vip) ++vip_streak;
-    else     vip_streak = 0;
-
-    {
-        std::ostringstream oss;
-        oss << "ENTER id=" << tourist_id << " vip=" << (vip ? 1 : 0)
-            << " occ=" << inside << "/" << cap
-            << " wait_vip=" << waiting_vip
-            << " wait_norm=" << waiting_norm
-            << " vip_streak=" << vip_streak;
-        log.log_ts("TOWER", oss.str());
+        t->granted = true;
+        t->cv.notify_all();
     }
+}
 
-    lk.unlock();
-    cv.notify_all();
+/**
+ * @brief Block on the ticket's own condition until slots were handed over.
+ */
+CoTask Tower::wait_ticket(std::unique_lock<std::mutex>& lk, SlotQueue::Ticket& t) {
+    grant_locked();
+    while (!t.granted) co_await t.cv.wait(lk);
+}
+
+/**
+ * @brief Enter tower as single visitor with VIP fairness logic.
+ */
+CoTask Tower::enter(int tourist_id, bool vip) {
+    std::unique_lock<std::mutex> lk(mu);
+
+    SlotQueue::Ticket t(tourist_id, 1, vip, false, Direction::NONE);
+    slots.join(&t);
+    bus.emit(TowerQueueJoin{tourist_id, vip, slots.waiting_vip, slots.waiting_norm});
+
+    co_await wait_ticket(lk, t);
 }
 
 /**
@@ -126,75 +258,26 @@ void Tower::enter(int tourist_id, bool vip) {
 void Tower::leave(int tourist_id) {
     std::unique_lock<std::mutex> lk(mu);
 
-    if (inside > 0) --inside;
-
-    {
-        std::ostringstream oss;
-        oss << "LEAVE id=" << tourist_id
-            << " occ=" << inside << "/" << cap;
-        log.log_ts("TOWER", oss.str());
-    }
+    if (slots.used > 0) --slots.used;
+    bus.emit(TowerLeave{tourist_id, slots.used, cap});
 
-    lk.unlock();
-    cv.notify_all();
+    grant_locked();
 }
 
 // ---- Tower: wejście grupowe ----
 /**
  * @brief Enter tower as group occupying k slots with VIP-like priority toggle.
  */
-void Tower::enter_group(int group_id, int k, bool vip_like) {
-    if (k <= 0) return;
+CoTask Tower::enter_group(int group_id, int k, bool vip_like) {
+    if (k <= 0) co_return;
 
     std::unique_lock<std::mutex> lk(mu);
 
-    if (vip_like) waiting_vip += k;
-    else          waiting_norm += k;
-
-    {
-        std::ostringstream oss;
-        oss << "GROUP_QUEUE_JOIN gid=" << group_id
-            << " k=" << k
-            << " vip_like=" << (vip_like ? 1 : 0)
-            << " wait_vip=" << waiting_vip
-            << " wait_norm=" << waiting_norm;
-        log.log_ts("TOWER", oss.str());
-    }
-
-    cv.wait(lk, [&]{
-        if (inside + k > cap) return false;
-
-        if (vip_like) {
-            if (waiting_norm > 0 && vip_streak >= VIP_BURST) return false;
-            return true;
-        } else {
-            if (waiting_vip == 0) return true;
-            if (vip_streak >= VIP_BURST) return true;
-            return false;
-        }
-    });
-
-    if (vip_like) waiting_vip -= k;
-    else          waiting_norm -= k;
-
-    inside += k;
-    if (vip_like) ++vip_streak;
-    else          vip_streak = 0;
-
-    {
-        std::ostringstream oss;
-        oss << "GROUP_ENTER gid=" << group_id
-            << " k=" << k
-            << " vip_like=" << (vip_like ? 1 : 0)
-            << " occ=" << inside << "/" << cap
-            << " wait_vip=" << waiting_vip
-            << " wait_norm=" << waiting_norm
-            << " vip_streak=" << vip_streak;
-        log.log_ts("TOWER", oss.str());
-    }
+    SlotQueue::Ticket t(group_id, k, vip_like, true, Direction::NONE);
+    slots.join(&t);
+    bus.emit(TowerGroupQueueJoin{group_id, k, vip_like, slots.waiting_vip, slots.waiting_norm});
 
-    lk.unlock();
-    cv.notify_all();
+    co_await wait_ticket(lk, t);
 }
 
 /**
@@ -205,181 +288,196 @@ void Tower::leave_group(int group_id, int k) {
 
     std::unique_lock<std::mutex> lk(mu);
 
-    inside -= k;
-    if (inside < 0) inside = 0;
+    slots.used -= k;
+    if (slots.used < 0) slots.used = 0;
+    bus.emit(TowerGroupLeave{group_id, k, slots.used, cap});
 
-    {
-        std::ostringstream oss;
-        oss << "GROUP_LEAVE gid=" << group_id
-            << " k=" << k
-            << " occ=" << inside << "/" << cap;
-        log.log_ts("TOWER", oss.str());
-    }
+    grant_locked();
+}
 
-    lk.unlock();
-    cv.notify_all();
+/**
+ * @brief Occupancy and waiting slots under mu.
+ */
+Tower::Snapshot Tower::snapshot() {
+    std::lock_guard<std::mutex> lk(mu);
+    return Snapshot{slots.used, slots.waiting_vip, slots.waiting_norm};
 }
 
 // ------------------------- FERRY (C) -------------------------
 
+static int ferry_bank(Direction d) { return d == Direction::BACKWARD ? 1 : 0; }
+static Direction ferry_dir(int bank) { return bank == 0 ? Direction::FORWARD : Direction::BACKWARD; }
+
 /**
- * @brief Initialize ferry monitor with capacity and logger.
+ * @brief Initialize ferry at bank 0 with capacity, crossing time and event bus.
  */
-Ferry::Ferry(int cap_, Logger& log_) : cap(cap_), log(log_) {}
+Ferry::Ferry(int cap_, int cross_ms_, EventBus& bus_)
+    : cap(cap_), cross_ms(cross_ms_), bus(bus_), slots{SlotQueue(cap_), SlotQueue(cap_)} {}
 
 /**
- * @brief Board ferry as single visitor with VIP fairness and direction log.
+ * @brief Take tickets from the current bank while they fit; logs BOARD on their behalf.
  */
-void Ferry::board(int tourist_id, bool vip, Direction d) {
-    std::unique_lock<std::mutex> lk(mu);
-
-    if (vip) ++waiting_vip;
-    else     ++waiting_norm;
-
-    {
-        std::ostringstream oss;
-        oss << "QUEUE_JOIN id=" << tourist_id
-            << " vip=" << (vip ? 1 : 0)
-            << " dir=" << dir_str(d)
-            << " wait_vip=" << waiting_vip
-            << " wait_norm=" << waiting_norm;
-        log.log_ts("FERRY", oss.str());
+int Ferry::load_locked() {
+    SlotQueue& q = slots[bank];
+    int b = bank;
+    int64_t now = SimClock::global().now_ms();
+
+    // Najpierw kolejność z fairness; gdy czoło się nie mieści, dopełniamy kurs
+    // biletami, które się zmieszczą. Pominięte czoło i tak płynie następnym kursem.
+    q.used = 0;
+    while (true) {
+        SlotQueue::Ticket* t = q.next_grant();
+        if (!t) t = q.next_fill();
+        if (!t) break;
+
+        if (t->group) {
+            bus.emit(FerryGroupBoard{t->id, t->k, t->vip, t->d, q.used, cap, q.waiting_vip,
+                                     q.waiting_norm, q.vip_streak});
+        } else {
+            bus.emit(FerryBoard{t->id, t->vip, t->d, q.used, cap, q.waiting_vip,
+                                q.waiting_norm, q.vip_streak});
+        }
+        int64_t w = now - t->t_join;
+        ++st_.boarded[b];
+        st_.wait_ms[b] += w;
+        if (w > st_.wait_max_ms[b]) st_.wait_max_ms[b] = w;
+        onboard.push_back(t);
     }
+    return q.used;
+}
 
-    cv.wait(lk, [&]{
-        if (onboard >= cap) return false;
+/**
+ * @brief Log UNBOARD and release every passenger of the finished trip.
+ */
+void Ferry::unload_locked() {
+    int occ = 0;
+    for (auto* t : onboard) occ += t->k;
+
+    for (auto* t : onboard) {
+        // Po notify bilet (ramka pasażera) może zniknąć, gdy tylko oddamy mu.
+        occ -= t->k;
+        if (t->group) bus.emit(FerryGroupUnboard{t->id, t->k, occ, cap});
+        else bus.emit(FerryUnboard{t->id, occ, cap});
+        t->granted = true;
+        t->cv.notify_all();
+    }
+    onboard.clear();
+}
 
-        if (vip) {
-            if (waiting_norm > 0 && vip_streak >= VIP_BURST) return false;
-            return true;
-        } else {
-            if (waiting_vip == 0) return true;
-            if (vip_streak >= VIP_BURST) return true;
-            return false;
-        }
-    });
-
-    if (vip) --waiting_vip;
-    else     --waiting_norm;
-
-    ++onboard;
-    if (vip) ++vip_streak;
-    else     vip_streak = 0;
-
-    {
-        std::ostringstream oss;
-        oss << "BOARD id=" << tourist_id
-            << " vip=" << (vip ? 1 : 0)
-            << " dir=" << dir_str(d)
-            << " occ=" << onboard << "/" << cap
-            << " wait_vip=" << waiting_vip
-            << " wait_norm=" << waiting_norm
-            << " vip_streak=" << vip_streak;
-        log.log_ts("FERRY", oss.str());
+/**
+ * @brief Shuttle loop: wait for passengers, load here (or sail empty for the other bank), cross, unload.
+ */
+CoTask Ferry::run() {
+    std::unique_lock<std::mutex> lk(mu);
+    while (true) {
+        while (!stopping && slots[0].empty() && slots[1].empty()) co_await cv.wait(lk);
+        if (slots[0].empty() && slots[1].empty()) break;
+
+        int load = load_locked();
+        Direction d = ferry_dir(bank);
+        int trip = static_cast<int>(++st_.trips);
+        st_.seats += static_cast<uint64_t>(load);
+        if (load == 0) ++st_.empty_trips;   // tu pusto, płyniemy po czekających z drugiego brzegu
+        bus.emit(FerryDepart{trip, d, load, cap});
+
+        crossing = true;
+        lk.unlock();
+        co_await co_sleep(cross_ms);
+        lk.lock();
+
+        crossing = false;
+        bank ^= 1;
+        bus.emit(FerryArrive{trip, d, load});
+        unload_locked();
     }
 
-    lk.unlock();
+    stopped = true;
+    stopped_cv.notify_all();
+}
+
+/**
+ * @brief Ask the shuttle loop to exit once it is idle.
+ */
+void Ferry::shutdown() {
+    std::lock_guard<std::mutex> lk(mu);
+    stopping = true;
     cv.notify_all();
 }
 
 /**
- * @brief Unboard ferry as single visitor.
+ * @brief Wait for run() to return (coro mode, where there is no thread to join).
  */
-void Ferry::unboard(int tourist_id) {
+void Ferry::wait_stopped() {
     std::unique_lock<std::mutex> lk(mu);
+    stopped_cv.wait(lk, [&]{ return stopped; });
+}
 
-    if (onboard > 0) --onboard;
+/**
+ * @brief Snapshot of the counters.
+ */
+Ferry::Stats Ferry::stats() {
+    std::lock_guard<std::mutex> lk(mu);
+    return st_;
+}
 
-    {
-        std::ostringstream oss;
-        oss << "UNBOARD id=" << tourist_id
-            << " occ=" << onboard << "/" << cap;
-        log.log_ts("FERRY", oss.str());
+/**
+ * @brief Position and per-bank waiting seats under mu.
+ */
+Ferry::Snapshot Ferry::snapshot() {
+    std::lock_guard<std::mutex> lk(mu);
+    Snapshot sn;
+    sn.bank = bank;
+    sn.crossing = crossing;
+    for (int b = 0; b < 2; ++b) {
+        sn.waiting_vip[b] = slots[b].waiting_vip;
+        sn.waiting_norm[b] = slots[b].waiting_norm;
     }
+    return sn;
+}
 
-    lk.unlock();
+/**
+ * @brief Put the ticket in its departure bank's queue and wake the ferry.
+ */
+SlotQueue& Ferry::join_locked(SlotQueue::Ticket& t) {
+    SlotQueue& q = slots[ferry_bank(t.d)];
+    t.t_join = SimClock::global().now_ms();
+    q.join(&t);
     cv.notify_all();
+    return q;
 }
 
-// ---- Ferry: wejście grupowe ----
 /**
- * @brief Board ferry as group occupying k slots with VIP-like fairness.
+ * @brief Block on the ticket's own condition until unloaded on the other bank.
  */
-void Ferry::board_group(int group_id, int k, bool vip_like, Direction d) {
-    if (k <= 0) return;
+CoTask Ferry::wait_ticket(std::unique_lock<std::mutex>& lk, SlotQueue::Ticket& t) {
+    while (!t.granted) co_await t.cv.wait(lk);
+}
 
+/**
+ * @brief Cross as single visitor with VIP fairness on the departure bank.
+ */
+CoTask Ferry::ride(int tourist_id, bool vip, Direction d) {
     std::unique_lock<std::mutex> lk(mu);
 
-    if (vip_like) waiting_vip += k;
-    else          waiting_norm += k;
-
-    {
-        std::ostringstream oss;
-        oss << "GROUP_QUEUE_JOIN gid=" << group_id
-            << " k=" << k
-            << " vip_like=" << (vip_like ? 1 : 0)
-            << " dir=" << dir_str(d)
-            << " wait_vip=" << waiting_vip
-            << " wait_norm=" << waiting_norm;
-        log.log_ts("FERRY", oss.str());
-    }
-
-    cv.wait(lk, [&]{
-        if (onboard + k > cap) return false;
-
-        if (vip_like) {
-            if (waiting_norm > 0 && vip_streak >= VIP_BURST) return false;
-            return true;
-        } else {
-            if (waiting_vip == 0) return true;
-            if (vip_streak >= VIP_BURST) return true;
-            return false;
-        }
-    });
-
-    if (vip_like) waiting_vip -= k;
-    else          waiting_norm -= k;
-
-    onboard += k;
-    if (vip_like) ++vip_streak;
-    else          vip_streak = 0;
-
-    {
-        std::ostringstream oss;
-        oss << "GROUP_BOARD gid=" << group_id
-            << " k=" << k
-            << " vip_like=" << (vip_like ? 1 : 0)
-            << " dir=" << dir_str(d)
-            << " occ=" << onboard << "/" << cap
-            << " wait_vip=" << waiting_vip
-            << " wait_norm=" << waiting_norm
-            << " vip_streak=" << vip_streak;
-        log.log_ts("FERRY", oss.str());
-    }
+    SlotQueue::Ticket t(tourist_id, 1, vip, false, d);
+    SlotQueue& q = join_locked(t);
+    bus.emit(FerryQueueJoin{tourist_id, vip, d, q.waiting_vip, q.waiting_norm});
 
-    lk.unlock();
-    cv.notify_all();
+    co_await wait_ticket(lk, t);
 }
 
+// ---- Ferry: przeprawa grupowa ----
 /**
- * @brief Unboard ferry as group releasing k slots.
+ * @brief Cross as group occupying k seats on one trip.
  */
-void Ferry::unboard_group(int group_id, int k) {
-    if (k <= 0) return;
+CoTask Ferry::ride_group(int group_id, int k, bool vip_like, Direction d) {
+    if (k <= 0) co_return;
 
     std::unique_lock<std::mutex> lk(mu);
 
-    onboard -= k;
-    if (onboard < 0) onboard = 0;
+    SlotQueue::Ticket t(group_id, k, vip_like, true, d);
+    SlotQueue& q = join_locked(t);
+    bus.emit(FerryGroupQueueJoin{group_id, k, vip_like, d, q.waiting_vip, q.waiting_norm});
 
-    {
-        std::ostringstream oss;
-        oss << "GROUP_UNBOARD gid=" << group_id
-            << " k=" << k
-            << " occ=" << onboard << "/" << cap;
-        log.log_ts("FERRY", oss.str());
-    }
-
-    lk.unlock();
-    cv.notify_all();
+    co_await wait_ticket(lk, t);
 }
@@ -0,0 +1,85 @@
+#include "shm_arena.hpp"
+
+#include <cerrno>
+#include <cstdio>
+
+#include "futex.hpp"
+
+/**
+ * @brief Drepper's mutex: uncontended lock and unlock never enter the kernel.
+ */
+void ShmMutex::lock() {
+    uint32_t c = 0;
+    if (state_.compare_exchange_strong(c, 1, std::memory_order_acquire)) return;
+    contended_.fetch_add(1, std::memory_order_relaxed);
+    if (c != 2) c = state_.exchange(2, std::memory_order_acquire);
+    while (c != 0) {
+        futex_wait(state_, 2);
+        c = state_.exchange(2, std::memory_order_acquire);
+    }
+}
+
+/**
+ * @brief 0 -> 1 or nothing.
+ */
+bool ShmMutex::try_lock() {
+    uint32_t c = 0;
+    return state_.compare_exchange_strong(c, 1, std::memory_order_acquire);
+}
+
+/**
+ * @brief 1 -> 0 without a syscall; from 2 wake one sleeper.
+ */
+void ShmMutex::unlock() {
+    if (state_.fetch_sub(1, std::memory_order_release) != 1) {
+        state_.store(0, std::memory_order_release);
+        if (futex_wake(state_, 1) < 0) perror("futex(wake mutex)");
+    }
+}
+
+/**
+ * @brief Fresh segment with the allocation header at offset 0.
+ */
+int ShmArena::create(const char* token_path, int proj_id, size_t size_bytes, int perms) {
+    if (size_bytes <= sizeof(Header)) { errno = EINVAL; perror("arena: size too small"); return -1; }
+    if (shm_.create_or_open(token_path, proj_id, size_bytes, perms) < 0) return -1;
+    if (shm_.remove() < 0) return -1;
+    if (shm_.create_or_open(token_path, proj_id, size_bytes, perms) < 0) return -1;
+    void* a = shm_.attach();
+    if (!a) return -1;
+    h_ = new (a) Header();
+    h_->top.store(sizeof(Header), std::memory_order_relaxed);
+    size_ = size_bytes;
+    return 0;
+}
+
+/**
+ * @brief Detach and remove the segment.
+ */
+int ShmArena::remove() {
+    h_ = nullptr;
+    size_ = 0;
+    if (shm_.detach() < 0) return -1;
+    return shm_.remove();
+}
+
+/**
+ * @brief Bump allocation: align the top, CAS it forward.
+ */
+void* ShmArena::allocate(size_t bytes, size_t align) {
+    if (!h_) return nullptr;
+    char* base = reinterpret_cast<char*>(h_);
+    uint64_t top = h_->top.load(std::memory_order_relaxed);
+    while (true) {
+        const uint64_t start = (top + align - 1) & ~static_cast<uint64_t>(align - 1);
+        if (start + bytes > size_) return nullptr;
+        if (h_->top.compare_exchange_weak(top, start + bytes, std::memory_order_relaxed)) return base + start;
+    }
+}
+
+/**
+ * @brief Current top of the bump allocator.
+ */
+size_t ShmArena::used() const {
+    return h_ ? static_cast<size_t>(h_->top.load(std::memory_order_relaxed)) : 0;
+}
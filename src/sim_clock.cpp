@@ -0,0 +1,225 @@
+#include "sim_clock.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Process-wide clock instance.
+ */
+SimClock& SimClock::global() {
+    static SimClock clk;
+    return clk;
+}
+
+/**
+ * @brief Reset time origin and launch the driver thread in virtual mode.
+ */
+void SimClock::start() {
+    t0_ = std::chrono::steady_clock::now();
+    if (!is_virtual()) return;
+
+    std::lock_guard<std::mutex> lk(mu_);
+    vnow_ = 0;
+    stop_ = false;
+    driver_ = std::thread(&SimClock::drive, this);
+}
+
+/**
+ * @brief Stop and join the driver thread.
+ */
+void SimClock::stop() {
+    {
+        std::lock_guard<std::mutex> lk(mu_);
+        stop_ = true;
+    }
+    kick_cv_.notify_all();
+    rt_cv_.notify_all();
+    if (driver_.joinable()) driver_.join();
+    if (rt_timer_.joinable()) rt_timer_.join();
+}
+
+/**
+ * @brief Milliseconds since start(), simulated in virtual mode.
+ */
+int64_t SimClock::now_ms() {
+    if (is_virtual()) {
+        std::lock_guard<std::mutex> lk(mu_);
+        return vnow_;
+    }
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now - t0_).count();
+}
+
+/**
+ * @brief Sleep in simulation time; virtual sleepers wait for the driver.
+ */
+void SimClock::sleep_ms(int ms) {
+    if (ms <= 0) return;
+    if (!is_virtual()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return;
+    }
+
+    std::unique_lock<std::mutex> lk(mu_);
+    int64_t due = vnow_ + ms;
+    wakeups_.insert(due);
+    --running_;
+    if (running_ <= 0) kick_cv_.notify_one();
+
+    // Driver ponownie liczy nas jako running_ w chwili przesunięcia czasu.
+    tick_cv_.wait(lk, [&]{ return vnow_ >= due; });
+}
+
+/**
+ * @brief Schedule a callback after @p ms of simulation time.
+ */
+SimClock::TimerId SimClock::call_after(int ms, std::function<void()> fn) {
+    if (ms <= 0) {
+        hold();
+        fn();
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lk(mu_);
+    TimerId id = ++next_timer_;
+    if (is_virtual()) {
+        vtimers_.emplace(vnow_ + ms, std::make_pair(id, std::move(fn)));
+        return id;
+    }
+
+    auto due = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    rt_timers_.emplace(due, std::make_pair(id, std::move(fn)));
+    if (!rt_timer_.joinable()) {
+        stop_ = false;
+        rt_timer_ = std::thread(&SimClock::run_real_timers, this);
+    }
+    rt_cv_.notify_one();
+    return id;
+}
+
+/**
+ * @brief Remove a pending timer (linear scan; used rarely, e.g. on an emptied queue).
+ */
+bool SimClock::cancel(TimerId id) {
+    if (id == 0) return false;
+    std::lock_guard<std::mutex> lk(mu_);
+    auto drop = [id](auto& timers) {
+        for (auto it = timers.begin(); it != timers.end(); ++it) {
+            if (it->second.first == id) {
+                timers.erase(it);
+                return true;
+            }
+        }
+        return false;
+    };
+    return drop(vtimers_) || drop(rt_timers_);
+}
+
+/**
+ * @brief Real-mode timer loop.
+ */
+void SimClock::run_real_timers() {
+    std::unique_lock<std::mutex> lk(mu_);
+    while (!stop_ || !rt_timers_.empty()) {
+        if (rt_timers_.empty()) {
+            rt_cv_.wait(lk, [&]{ return stop_ || !rt_timers_.empty(); });
+            continue;
+        }
+        auto due = rt_timers_.begin()->first;
+        if (std::chrono::steady_clock::now() < due) {
+            rt_cv_.wait_until(lk, due);
+            continue;
+        }
+        auto fn = std::move(rt_timers_.begin()->second.second);
+        rt_timers_.erase(rt_timers_.begin());
+        lk.unlock();
+        fn();
+        lk.lock();
+    }
+}
+
+/**
+ * @brief Count queued or woken work as running (virtual mode only).
+ */
+void SimClock::hold(int n) {
+    if (!is_virtual()) return;
+    std::lock_guard<std::mutex> lk(mu_);
+    running_ += n;
+}
+
+/**
+ * @brief Drop a held unit; may let virtual time advance.
+ */
+void SimClock::release() {
+    if (!is_virtual()) return;
+    std::lock_guard<std::mutex> lk(mu_);
+    --running_;
+    if (running_ <= 0) kick_cv_.notify_one();
+}
+
+/**
+ * @brief Count a freshly spawned actor as running.
+ */
+void SimClock::actor_spawned() {
+    if (!is_virtual()) return;
+    std::lock_guard<std::mutex> lk(mu_);
+    ++running_;
+}
+
+/**
+ * @brief Remove the calling actor from the running count.
+ */
+void SimClock::actor_finished() {
+    if (!is_virtual()) return;
+    std::lock_guard<std::mutex> lk(mu_);
+    --running_;
+    if (running_ <= 0) kick_cv_.notify_one();
+}
+
+/**
+ * @brief Actor is about to block on a monitor.
+ */
+void SimClock::block_begin() {
+    std::lock_guard<std::mutex> lk(mu_);
+    --running_;
+    if (running_ <= 0) kick_cv_.notify_one();
+}
+
+/**
+ * @brief Advance virtual time to the next wakeup whenever nobody is runnable.
+ */
+void SimClock::drive() {
+    auto pending = [&]{ return !wakeups_.empty() || !vtimers_.empty(); };
+
+    std::unique_lock<std::mutex> lk(mu_);
+    while (!stop_) {
+        kick_cv_.wait(lk, [&]{ return stop_ || (running_ <= 0 && pending()); });
+        if (stop_) break;
+
+        int64_t next = INT64_MAX;
+        if (!wakeups_.empty()) next = *wakeups_.begin();
+        if (!vtimers_.empty() && vtimers_.begin()->first < next) next = vtimers_.begin()->first;
+        vnow_ = next;
+
+        auto end = wakeups_.upper_bound(vnow_);
+        for (auto it = wakeups_.begin(); it != end; ++it) ++running_;
+        wakeups_.erase(wakeups_.begin(), end);
+
+        // Każdy timer dostaje jedną jednostkę running_ (przekazuje ją dalej).
+        std::vector<std::function<void()>> due;
+        auto tend = vtimers_.upper_bound(vnow_);
+        for (auto it = vtimers_.begin(); it != tend; ++it) {
+            due.push_back(std::move(it->second.second));
+            ++running_;
+        }
+        vtimers_.erase(vtimers_.begin(), tend);
+
+        tick_cv_.notify_all();
+
+        if (!due.empty()) {
+            lk.unlock();
+            for (auto& fn : due) fn();
+            lk.lock();
+        }
+    }
+}
@@ -5,20 +5,40 @@
 
 #include <algorithm>
 #include <chrono>
-#include <sstream>
 #include <thread>
+#include <utility>
 
 /**
  * @brief Construct a tourist with identifiers and VIP flag.
  */
 Tourist::Tourist(int id_, int age_, bool vip_, Park* park_)
-    : id(id_), age(age_), vip(vip_), park(park_) {}
+    : id(id_), age(age_), vip(vip_), park(park_),
+      rng(park_->cfg.seed, RngStream::TOURIST, static_cast<uint64_t>(id_)) {}
 
 /**
- * @brief Launch the tourist thread.
+ * @brief Launch the tourist thread or spawn its task on the scheduler.
  */
-void Tourist::start() {
-    thr = std::thread(&Tourist::run, this);
+void Tourist::start(std::function<void(Tourist*)> done) {
+    on_done = std::move(done);
+    if (park->sched) {
+        park->sched->spawn(run_and_finish());
+        return;
+    }
+    park->clock.actor_spawned();
+    thr = std::thread([this] {
+        SimClock::ActorGuard actor(park->clock);
+        run_and_finish().run_inline();
+    });
+}
+
+/**
+ * @brief Tourist body followed by the completion callback.
+ */
+CoTask Tourist::run_and_finish() {
+    co_await run();
+    // Kopia w ramce korutyny: callback może zwolnić turystę razem z on_done.
+    auto done = std::move(on_done);
+    if (done) done(this);
 }
 
 /**
@@ -46,6 +66,15 @@ void Tourist::on_rejected() {
     cv.notify_all();
 }
 
+/**
+ * @brief Mark tourist as gone from the entry queue after the patience timeout.
+ */
+void Tourist::on_reneged() {
+    std::lock_guard<std::mutex> lk(mu);
+    reneged = true;
+    cv.notify_all();
+}
+
 /**
  * @brief Assign group id and guide id.
  */
@@ -86,13 +115,13 @@ void Tourist::set_guardian(Tourist* g, bool is_u5_child) {
 /**
  * @brief Sleep in small slices while honoring abort flag.
  */
-static void sleep_interruptible_ms(int total_ms, std::atomic<bool>& abort_flag) {
+static CoTask sleep_interruptible_ms(int total_ms, std::atomic<bool>& abort_flag) {
     int slice = 50;
     int slept = 0;
     while (slept < total_ms) {
-        if (abort_flag.load()) return;
+        if (abort_flag.load()) co_return;
         int d = std::min(slice, total_ms - slept);
-        std::this_thread::sleep_for(std::chrono::milliseconds(d));
+        co_await co_sleep(d);
         slept += d;
     }
 }
@@ -109,19 +138,16 @@ void Tourist::guardian_notify_wards_ready(int epoch) {
 /**
  * @brief Child waits until guardian ready for epoch or abort is triggered.
  */
-void Tourist::child_wait_for_guardian_ready(int epoch, const char* where) {
-    if (!guardian) return;
+CoTask Tourist::child_wait_for_guardian_ready(int epoch, char where) {
+    if (!guardian) co_return;
 
     std::unique_lock<std::mutex> lk(guardian->escort_mu);
-    guardian->escort_cv.wait(lk, [&] {
-        return guardian->escort_epoch >= epoch || abort_to_k.load();
-    });
+    while (guardian->escort_epoch < epoch && !abort_to_k.load()) {
+        co_await guardian->escort_cv.wait(lk);
+    }
 
     if (abort_to_k.load()) {
-        park->log.log_ts("GUARD",
-                         std::string("CHILD_ABORT_WAIT id=") + std::to_string(id) +
-                         " where=" + where +
-                         " gid=" + std::to_string(group_id));
+        park->bus.emit(GuardChildAbortWait{id, where, group_id});
     }
 }
 
@@ -133,128 +159,124 @@ static Direction dir_from_route(int route, Direction d_for_route1, Direction d_f
 }
 
 /**
- * @brief Main tourist thread entry: admission then VIP or guided path.
+ * @brief Main tourist entry: admission then VIP or guided path.
  */
-void Tourist::run() {
-    {
-        std::ostringstream oss;
-        oss << "ARRIVE id=" << id << " age=" << age << " vip=" << (vip ? 1 : 0);
-        park->log.log_ts("TOURIST", oss.str());
-    }
+CoTask Tourist::run() {
+    park->bus.emit(TouristArrive{id, age, vip});
 
-    park->enqueue_entry(this);
+    if (!park->enqueue_entry(this)) co_return;   // kolejka pełna: BALK zalogował park
 
     {
         std::unique_lock<std::mutex> lk(mu);
-        cv.wait(lk, [&] { return admitted || rejected; });
+        while (!admitted && !rejected && !reneged) co_await cv.wait(lk);
     }
 
+    if (reneged) co_return;   // RENEGE zalogował park
     if (rejected) {
-        park->log.log_ts("TOURIST", "LEAVE_NO_ENTRY id=" + std::to_string(id));
-        return;
+        park->bus.emit(TouristLeaveNoEntry{id});
+        co_return;
     }
 
-    if (vip) run_vip();
-    else run_guided();
+    if (vip || !park->cfg.guided()) co_await run_solo();
+    else co_await run_guided();
 }
 
 /**
- * @brief VIP unguided visit flow with segment, bridge, tower, ferry.
+ * @brief Unguided visit flow with segment, bridge, tower, ferry (VIP, or anyone with --workload=solo).
  */
-void Tourist::run_vip() {
-    if (age < 15) {
-        park->log.log_ts("VIP",
-                         "DENY_CHILD id=" + std::to_string(id) +
-                         " age=" + std::to_string(age) +
-                         " reason=NEEDS_GUARDIAN");
+CoTask Tourist::run_solo() {
+    if (vip && age < 15) {
+        park->bus.emit(VipDenyChild{id, age});
         park->report_exit(id);
-        return;
+        co_return;
     }
 
-    int route = park->rand_int(1, 2);
-    park->log.log_ts("VIP", "START id=" + std::to_string(id) + " route=" + std::to_string(route));
+    int route = park->choose_route(rng, 1, vip);
+    if (vip) park->bus.emit(VipStart{id, route});
 
-    auto segment_sleep = [&] {
-        int ms = park->rand_int(park->cfg.segment_min_ms, park->cfg.segment_max_ms);
-        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    // Jak grupa z dzieckiem < 12: odcinki x1.5 (VIP ma >= 15 lat, dotyczy tylko solo).
+    const bool slow = age < 12;
+
+    // Lambdy-korutyny żyją w ramce run_solo(), a każde wywołanie jest od razu co_await-owane.
+    auto segment_sleep = [&]() -> CoTask {
+        int ms = rng.uniform_int(park->cfg.segment_min_ms, park->cfg.segment_max_ms);
+        co_await co_sleep(slow ? (ms * 3) / 2 : ms);
     };
 
-    auto bridge_cross = [&](Direction d) {
-        park->bridge.enter(id, d);
-        int ms = park->rand_int(park->cfg.bridge_min_ms, park->cfg.bridge_max_ms);
-        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    auto bridge_cross = [&](Direction d) -> CoTask {
+        co_await park->bridge.enter(id, d);
+        int ms = rng.uniform_int(park->cfg.bridge_min_ms, park->cfg.bridge_max_ms);
+        park->bridge_svc_ms.add(ms);
+        co_await co_sleep(ms);
         park->bridge.leave(id);
     };
 
-    auto tower_visit = [&] {
+    auto tower_visit = [&]() -> CoTask {
         if (age <= 5) {
-            park->log.log_ts("VIP", "TOWER_SKIP id=" + std::to_string(id) + " reason=AGE<=5");
-            return;
+            if (vip) park->bus.emit(VipTowerSkip{id});
+            else park->bus.emit(TowerDenyAge5{id});
+            co_return;
         }
-        park->tower.enter(id, true);
-        int ms = park->rand_int(park->cfg.tower_min_ms, park->cfg.tower_max_ms);
-        sleep_interruptible_ms(ms, abort_to_k);
+        co_await park->tower.enter(id, vip);
+        int ms = rng.uniform_int(park->cfg.tower_min_ms, park->cfg.tower_max_ms);
+        park->tower_svc_ms.add(ms);
+        co_await sleep_interruptible_ms(ms, abort_to_k);
         park->tower.leave(id);
     };
 
-    auto ferry_cross = [&](Direction d) {
-        park->ferry.board(id, true, d);
-        std::this_thread::sleep_for(std::chrono::milliseconds(park->cfg.ferry_T_ms));
-        park->ferry.unboard(id);
+    auto ferry_cross = [&](Direction d) -> CoTask {
+        co_await park->ferry.ride(id, vip, d);
     };
 
     Direction bridge_dir = dir_from_route(route, Direction::FORWARD, Direction::BACKWARD);
     Direction ferry_dir  = dir_from_route(route, Direction::FORWARD, Direction::BACKWARD);
 
     if (route == 1) {
-        segment_sleep();
-        bridge_cross(bridge_dir);
-        segment_sleep();
-        tower_visit();
-        segment_sleep();
-        ferry_cross(ferry_dir);
-        segment_sleep();
+        co_await segment_sleep();
+        co_await bridge_cross(bridge_dir);
+        co_await segment_sleep();
+        co_await tower_visit();
+        co_await segment_sleep();
+        co_await ferry_cross(ferry_dir);
+        co_await segment_sleep();
     } else {
-        segment_sleep();
-        ferry_cross(ferry_dir);
-        segment_sleep();
-        tower_visit();
-        segment_sleep();
-        bridge_cross(bridge_dir);
-        segment_sleep();
+        co_await segment_sleep();
+        co_await ferry_cross(ferry_dir);
+        co_await segment_sleep();
+        co_await tower_visit();
+        co_await segment_sleep();
+        co_await bridge_cross(bridge_dir);
+        co_await segment_sleep();
     }
 
-    park->log.log_ts("VIP", "END id=" + std::to_string(id));
+    if (vip) park->bus.emit(VipEnd{id});
     park->report_exit(id);
 }
 
 /**
  * @brief Guided visit flow; waits for group and executes guided steps.
  */
-void Tourist::run_guided() {
+CoTask Tourist::run_guided() {
     park->enqueue_group_wait(this);
 
     {
         std::unique_lock<std::mutex> lk(mu);
-        cv.wait(lk, [&] { return group_id >= 0 || rejected; });
+        while (group_id < 0 && !rejected) co_await cv.wait(lk);
     }
 
     if (rejected) {
         park->report_exit(id);
-        return;
+        co_return;
     }
 
-    park->log.log_ts("TOURIST",
-                     "GROUP_JOIN id=" + std::to_string(id) +
-                     " gid=" + std::to_string(group_id) +
-                     " guide=" + std::to_string(guide_id));
+    park->bus.emit(TouristGroupJoin{id, group_id, guide_id});
 
     while (true) {
         Step s;
         int epoch;
         {
             std::unique_lock<std::mutex> lk(mu);
-            cv.wait(lk, [&] { return step_ready; });
+            while (!step_ready) co_await cv.wait(lk);
             s = next_step;
             epoch = step_epoch;
             step_ready = false;
@@ -263,7 +285,7 @@ void Tourist::run_guided() {
         if (s == Step::EXIT) {
             park->report_exit(id);
             if (group) group->mark_done();
-            return;
+            co_return;
         }
 
         if (abort_to_k.load() && s != Step::RETURN_K) {
@@ -271,7 +293,7 @@ void Tourist::run_guided() {
         }
 
         // Centralne wykonanie kroku w Parku (spójny punkt dla dalszej refaktoryzacji grupowej)
-        park->do_step(this, s, epoch);
+        co_await park->do_step(this, s, epoch);
 
         if (group) group->mark_done();
     }